@@ -4,7 +4,7 @@
     /* supported shell text colors */
     enum COLORS {
         RED, BLUE, YELLOW, DEFAULT, NUM_COLORS 
-    }COLOURS;
+    };
 
     /*
      * This stuct encapsulates the shell terminal line where users send input.
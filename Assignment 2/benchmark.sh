@@ -0,0 +1,95 @@
+#!/bin/bash
+# Scheduler benchmark.
+# Generates scripts shaped like sched1.txt-sched3.txt, runs them through exec in batch mode
+# under every quanta/CPU combination and prints one JSON object per combination.
+#
+# Usage: ./benchmark.sh [-k KERNEL] [-p PROGRAMS] [-l LINES] [-q "QUANTAS"] [-c "CPUS"] [-w WARMUP] [-r RUNS]
+#   -k KERNEL   kernel to benchmark (./mykernel by default)
+#   -p PROGRAMS number of scripts given to exec (100 by default)
+#   -l LINES    number of lines in each script (40 by default)
+#   -q QUANTAS  quantas to test ("2 5 20" by default)
+#   -c CPUS     numbers of CPUs to test ("1" up to the number of cores by default)
+#   -w WARMUP   runs discarded before measuring (1 by default)
+#   -r RUNS     measured runs (10 by default)
+
+kernel=./mykernel
+programs=100
+lines=40
+quantas="2 5 20"
+cpus=""
+warmup=1
+runs=10
+
+while getopts "k:p:l:q:c:w:r:" option; do
+    case $option in
+        k) kernel=$OPTARG ;;
+        p) programs=$OPTARG ;;
+        l) lines=$OPTARG ;;
+        q) quantas=$OPTARG ;;
+        c) cpus=$OPTARG ;;
+        w) warmup=$OPTARG ;;
+        r) runs=$OPTARG ;;
+        *) sed -n '6,13p' "$0" | cut -c3- >&2; exit 1 ;;
+    esac
+done
+
+if [ ! -x "$kernel" ]; then
+    echo "could not find $kernel, run compileKernel.sh first" >&2
+    exit 1
+fi
+kernel=$(realpath "$kernel")
+
+if [ -z "$cpus" ]; then
+    cores=$(nproc)
+    cpus=1
+    for ((n = 2; n <= cores; n *= 2)); do
+        cpus="$cpus $n"
+    done
+fi
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+# every script sets and prints its own variables, like sched1.txt-sched3.txt
+for ((p = 1; p <= programs; p++)); do
+    for ((i = 0; i < lines; i++)); do
+        if ((i % 2 == 0)); then
+            echo "set v$((i / 2 % 4)) p${p}_$i"
+        else
+            echo "print v$((i / 2 % 4))"
+        fi
+    done > "$workdir/sched$p.txt"
+    echo "sched$p.txt" >> "$workdir/manifest.txt"
+done
+printf 'exec @manifest.txt\nquit\n' > "$workdir/input.txt"
+
+# runs the kernel once and prints the elapsed time in nanoseconds
+runKernel() {
+    local start end
+    start=$(date +%s%N)
+    "$kernel" --batch "$workdir/input.txt" --quanta "$1" --cpus "$2" --stats "$workdir/stats.json" > /dev/null 2>&1
+    end=$(date +%s%N)
+    echo $((end - start))
+}
+
+cd "$workdir" || exit 1
+for quanta in $quantas; do
+    for cpu in $cpus; do
+        for ((i = 0; i < warmup; i++)); do
+            runKernel "$quanta" "$cpu" > /dev/null
+        done
+        for ((i = 0; i < runs; i++)); do
+            runKernel "$quanta" "$cpu"
+        done > times.txt
+        instructions=$(grep -o '"totals": *{[^}]*}' stats.json | grep -o '"instructions": *[0-9]*' | grep -o '[0-9]*$')
+
+        sort -n times.txt | awk -v quanta="$quanta" -v cpus="$cpu" -v programs="$programs" -v lines="$lines" -v instructions="${instructions:-0}" '
+            { times[NR] = $1 }
+            END {
+                median = (NR % 2) ? times[(NR + 1) / 2] : (times[NR / 2] + times[NR / 2 + 1]) / 2
+                p95 = times[int(NR * 0.95 + 0.999999)]
+                printf "{\"quanta\":%d,\"cpus\":%d,\"programs\":%d,\"lines\":%d,\"runs\":%d,", quanta, cpus, programs, lines, NR
+                printf "\"median_ms\":%.3f,\"p95_ms\":%.3f,\"instructions\":%d,\"instructions_per_sec\":%.0f}\n", median / 1e6, p95 / 1e6, instructions, instructions / (median / 1e9)
+            }'
+    done
+done
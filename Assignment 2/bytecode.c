@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bytecode.h"
+#include "shell.h"
+#include "shellmemory.h"
+
+static int countQuotes(const char* line);
+static int compileTokens(char* tokens[], struct instruction* instruction);
+static void storeConstants(char* constants[], int numberOfConstants, struct instruction* instruction);
+
+/*
+ * Function: bytecode_compile
+ * ----------------------------
+ *   Compile a script line into an instruction.
+ *   Variables are resolved to their shell memory slot, so they are not looked up by name when the line runs.
+ *   Lines the parser would reject are compiled to OP_INTERPRET, so their
+ *   error is printed when they run, like any other error of the script.
+ *
+ *   line: the script line
+ *   instruction: the instruction to write. Must be freed with bytecode_free()
+ */
+void bytecode_compile(char* line, struct instruction* instruction) {
+    instruction->opcode = OP_INTERPRET;
+    instruction->constants = NULL;
+
+    //parse() prints an error for open quotation marks and tokens that are too large.
+    //A line shorter than a token can also not hold more than NUM_TOKENS tokens
+    if (strlen(line) >= TOKENSIZE || countQuotes(line) % 2 == 1) {
+        return;
+    }
+
+    char *tokens[NUM_TOKENS] = {NULL};
+    if (!parse(line, ' ', tokens)) {
+        compileTokens(tokens, instruction);
+    }
+    tokens_destroy(tokens);
+}
+
+/*
+ * Function: bytecode_free
+ * ----------------------------
+ *   Free the constants of an instruction and turn it into OP_NOP.
+ *
+ *   instruction: the instruction to free
+ */
+void bytecode_free(struct instruction* instruction) {
+    free(instruction->constants);
+    instruction->constants = NULL;
+    instruction->opcode = OP_NOP;
+}
+
+/*
+ * Function: bytecode_operand
+ * ----------------------------
+ *   Return an operand of an instruction.
+ *
+ *   instruction: the instruction
+ *   index: index of the operand
+ *
+ *   return: the operand
+ */
+char* bytecode_operand(const struct instruction* instruction, int index) {
+    return instruction->constants + instruction->operands[index];
+}
+
+/*
+ * Function: countQuotes
+ * ----------------------------
+ *   Count the quotation marks of a line.
+ *
+ *   line: the script line
+ *
+ *   return: the number of quotation marks
+ */
+static int countQuotes(const char* line) {
+    int count = 0;
+    for (line = strchr(line, '\"'); line != NULL; line = strchr(line + 1, '\"')) {
+        count++;
+    }
+    return count;
+}
+
+/*
+ * Function: compileTokens
+ * ----------------------------
+ *   Compile a parsed line. Commands are only given an opcode when they have
+ *   the right number of arguments: the interpreter prints the error otherwise.
+ *   Lines whose variable cannot get a slot are interpreted as well.
+ *
+ *   tokens: the line in tokenized form
+ *   instruction: the instruction to write
+ *
+ *   return: the opcode of the instruction
+ */
+static int compileTokens(char* tokens[], struct instruction* instruction) {
+    int numberOfTokens = 0;
+    while (numberOfTokens < NUM_TOKENS && tokens[numberOfTokens] != NULL) {
+        numberOfTokens++;
+    }
+    if (numberOfTokens == 0) {
+        instruction->opcode = OP_NOP;
+    }
+    else if (numberOfTokens == 3 && !strcmp(tokens[0], "set") && strlen(tokens[1]) > 0) {
+        if ((instruction->slot = internVar(tokens[1])) != -1) {
+            instruction->opcode = OP_SET;
+            storeConstants(tokens + 1, 2, instruction);
+        }
+    }
+    else if (numberOfTokens == 2 && !strcmp(tokens[0], "print")) {
+        if ((instruction->slot = internVar(tokens[1])) != -1) {
+            instruction->opcode = OP_PRINT;
+            storeConstants(tokens + 1, 1, instruction);
+        }
+    }
+    else if (numberOfTokens == 2 && !strcmp(tokens[0], "echo")) {
+        instruction->opcode = OP_ECHO;
+        storeConstants(tokens + 1, 1, instruction);
+    }
+    return instruction->opcode;
+}
+
+/*
+ * Function: storeConstants
+ * ----------------------------
+ *   Copy the operands of an instruction one after the other in a single allocation.
+ *
+ *   constants: the operands
+ *   numberOfConstants: number of operands, at most 2
+ *   instruction: the instruction the operands belong to
+ */
+static void storeConstants(char* constants[], int numberOfConstants, struct instruction* instruction) {
+    size_t size = 0;
+    for (int i = 0; i < numberOfConstants; i++) {
+        size += strlen(constants[i]) + 1;
+    }
+    instruction->constants = (char*) malloc(size);
+
+    size_t offset = 0;
+    for (int i = 0; i < numberOfConstants; i++) {
+        size_t length = strlen(constants[i]) + 1;
+        memcpy(instruction->constants + offset, constants[i], length);
+        instruction->operands[i] = offset;
+        offset += length;
+    }
+}
\ No newline at end of file
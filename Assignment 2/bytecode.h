@@ -0,0 +1,58 @@
+#ifndef BYTECODE_HEADER
+    #define BYTECODE_HEADER
+
+    /*
+     * Script lines are compiled into instructions when they are loaded in RAM,
+     * so the CPU does not tokenize and look up the command of a line every time it runs it.
+     * Only the commands scripts use the most have an opcode. Every other line is
+     * compiled to OP_INTERPRET and given to the interpreter as before.
+    */
+    enum OPCODES {
+        OP_NOP,         //empty line
+        OP_SET,         //set VAR STRING. operands: VAR, STRING. slot: VAR
+        OP_PRINT,       //print VAR. operands: VAR. slot: VAR
+        OP_ECHO,        //echo STRING. operands: STRING
+        OP_INTERPRET    //any other line. Parsed and interpreted when it runs
+    };
+
+    struct instruction {
+        int opcode;
+        int operands[2];    //offsets of the operands in constants
+        int slot;           //shell memory slot of the variable, resolved when the line is compiled
+        char* constants;    //operands of the instruction, one after the other. NULL if there are none
+    };
+
+    /*
+    * Function: bytecode_compile
+    * ----------------------------
+    *   Compile a script line into an instruction.
+    *   Variables are resolved to their shell memory slot, so they are not looked up by name when the line runs.
+    *   Lines the parser would reject are compiled to OP_INTERPRET, so their
+    *   error is printed when they run, like any other error of the script.
+    *
+    *   line: the script line
+    *   instruction: the instruction to write. Must be freed with bytecode_free()
+    */
+    extern void bytecode_compile(char* line, struct instruction* instruction);
+
+    /*
+    * Function: bytecode_free
+    * ----------------------------
+    *   Free the constants of an instruction and turn it into OP_NOP.
+    *
+    *   instruction: the instruction to free
+    */
+    extern void bytecode_free(struct instruction* instruction);
+
+    /*
+    * Function: bytecode_operand
+    * ----------------------------
+    *   Return an operand of an instruction.
+    *
+    *   instruction: the instruction
+    *   index: index of the operand
+    *
+    *   return: the operand
+    */
+    extern char* bytecode_operand(const struct instruction* instruction, int index);
+#endif
\ No newline at end of file
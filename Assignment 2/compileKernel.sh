@@ -1,4 +1,4 @@
 #!/bin/bash
 echo "compiling mykernel..."
-gcc -c kernel.c shell.c interpreter.c shellmemory.c terminal-io.c pcb.c ram.c cpu.c; gcc -o mykernel kernel.o shell.o interpreter.o shellmemory.o terminal-io.o pcb.o ram.o cpu.o
+gcc -O2 -Wall -c kernel.c shell.c interpreter.c shellmemory.c terminal-io.c pcb.c ram.c cpu.c readyqueue.c stringset.c stats.c trace.c dircache.c fuzzy.c bytecode.c; gcc -O2 -pthread -o mykernel kernel.o shell.o interpreter.o shellmemory.o terminal-io.o pcb.o ram.o cpu.o readyqueue.o stringset.o stats.o trace.o dircache.o fuzzy.o bytecode.o
 echo "done!"
\ No newline at end of file
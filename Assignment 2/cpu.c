@@ -1,19 +1,23 @@
 #include <stdio.h>
-#include <string.h>
 #include "cpu.h"
 #include "pcb.h"
 #include "ram.h"
+#include "bytecode.h"
 #include "shell.h"
 #include "interpreter.h"
+#include "terminal-io.h"
+#include "trace.h"
 
 struct CPU {
     int IP; 
-    char IR[1000]; 
+    const struct instruction* IR; 
     int quanta;
 };
 
-struct CPU cpu = {-1, "", QUANTA};
-volatile int cpuIsAvailable = 1;
+static __thread struct CPU cpu = {-1, NULL, QUANTA};
+__thread volatile int cpuIsAvailable = 1;
+
+static int interpretLine(char* line);
 
 
 /*
@@ -27,25 +31,62 @@ volatile int cpuIsAvailable = 1;
  *   return: Whether the CPU encountered an error when running commands.
  */
 int run(int quanta) {
+    TRACE_BEGIN("run");
     cpuIsAvailable = 0;
-    char *tokens[NUM_TOKENS] = {NULL};
     int error = 0;
     while (quanta > 0) {
-        strcpy(cpu.IR, readRamLocation(cpu.IP));
-        if (!parse(cpu.IR, ' ', tokens))
-        {
-            if (interpreter(tokens) != 0)
-            {
-                tokens_destroy(tokens);
-                error = 1;
+        cpu.IR = readRamInstruction(cpu.IP);
+        switch (cpu.IR->opcode) {
+            case OP_NOP:
+                break;
+            case OP_SET:
+                TRACE_BEGIN("set");
+                error = interpreter_setSlot(cpu.IR->slot, bytecode_operand(cpu.IR, 0), bytecode_operand(cpu.IR, 1));
+                TRACE_END("set");
+                break;
+            case OP_PRINT:
+                TRACE_BEGIN("print");
+                error = interpreter_printSlot(cpu.IR->slot);
+                TRACE_END("print");
+                break;
+            case OP_ECHO:
+                TRACE_BEGIN("echo");
+                error = interpreter_echo(bytecode_operand(cpu.IR, 0));
+                TRACE_END("echo");
+                break;
+            default:
+                error = interpretLine(readRamLocation(cpu.IP));
                 break;
-            }
+        }
+        //the instruction may have printed over the line the user is typing
+        terminal_outputWritten();
+        if (error) {
+            break;
         }
         cpu.IP++;
-        tokens_destroy(tokens);
         quanta--;
     }
     cpuIsAvailable = 1;
+    TRACE_END("run");
+    return error;
+}
+
+/*
+ * Function: interpretLine
+ * ----------------------------
+ *   Parse and interpret a line that was compiled to OP_INTERPRET.
+ * 
+ *   line: the line stored in RAM
+ * 
+ *   return: 1 if the interpreter returned an error. 0 otherwise, even if the line could not be parsed.
+ */
+static int interpretLine(char* line) {
+    char *tokens[NUM_TOKENS] = {NULL};
+    TRACE_BEGIN("parse");
+    int parseError = parse(line, ' ', tokens);
+    TRACE_END("parse");
+    int error = (!parseError && interpreter(tokens) != 0);
+    tokens_destroy(tokens);
     return error;
 }
 
@@ -3,9 +3,11 @@
     #include "pcb.h"
 
     #define QUANTA 20
+    #define MAX_CPUS 64 //maximum number of CPUs the scheduler can run processes on
 
+    //every thread that runs processes acts as its own CPU. The CPU registers are therefore thread local.
     //cpuIsAvailable is false when the CPU is executing instructions (the run() function is running)
-    extern volatile int cpuIsAvailable;
+    extern __thread volatile int cpuIsAvailable;
 
     /*
     * Function: run
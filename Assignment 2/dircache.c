@@ -0,0 +1,313 @@
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include "dircache.h"
+
+#define LISTING_INITIAL_SIZE 64     //entries a listing holds before growing
+#define STORAGE_INITIAL_SIZE 1024   //bytes of names a listing holds before growing
+
+/*
+ * Listings of the directories that were completed most recently. When the cache is full,
+ * the listing that was used the longest time ago is replaced.
+ * cacheLock protects the cache: directories are read without holding it.
+*/
+static struct directoryListing cache[DIRCACHE_SIZE];
+static unsigned long cacheClock = 0;
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+//directories read by the prefetch thread
+static pthread_t prefetchThread;
+static int prefetchRunning = 0;
+static atomic_int prefetchCancelled = 0;
+static char* prefetchPaths[DIRCACHE_SIZE];
+static int prefetchCount = 0;
+
+static struct directoryListing* findListing(const char* path, const struct stat* status);
+static struct directoryListing* storeListing(struct directoryListing* newListing);
+static void* prefetch(void* arguments);
+static void stopPrefetch();
+static int readDirectory(struct directoryListing* listing, const char* path);
+static void freeListing(struct directoryListing* listing);
+static int compareNames(const void* a, const void* b);
+
+/*
+ * Function: dirCache_get
+ * ----------------------------
+ *   Return the listing of a directory. The directory is only read again
+ *   if its modification time changed since it was cached.
+ *   The cache stays locked until dirCache_release() is called, so the listing
+ *   cannot be replaced by the prefetch thread while it is used.
+ *
+ *   path: path of the directory
+ *
+ *   return: the listing of the directory. NULL if the directory could not be opened,
+ *           in which case the cache is not locked.
+ */
+struct directoryListing* dirCache_get(const char* path) {
+    struct stat status;
+    if (stat(path, &status) || !S_ISDIR(status.st_mode)) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cacheLock);
+    struct directoryListing* listing = findListing(path, &status);
+    if (listing == NULL) {
+        //do not block the prefetch thread while the directory is read
+        pthread_mutex_unlock(&cacheLock);
+        struct directoryListing newListing = {0};
+        if (readDirectory(&newListing, path)) {
+            return NULL;
+        }
+        newListing.modified = status.st_mtim;
+        pthread_mutex_lock(&cacheLock);
+        listing = storeListing(&newListing);
+    }
+    listing->lastUse = ++cacheClock;
+    return listing;
+}
+
+/*
+ * Function: dirCache_release
+ * ----------------------------
+ *   Unlock the cache once the listing returned by dirCache_get() is no longer used.
+ */
+void dirCache_release() {
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/*
+ * Function: dirCache_prefetch
+ * ----------------------------
+ *   Read directories into the cache on a background thread, so the first completion
+ *   in them does not wait for readdir(). Directories already cached and unmodified are skipped.
+ *   A prefetch still running is cancelled first.
+ *
+ *   paths: paths of the directories, most important first. Only the first DIRCACHE_SIZE are read.
+ *   count: number of paths
+ *
+ *   return: 0 if the prefetch thread was started. 1 otherwise.
+ */
+int dirCache_prefetch(const char* paths[], int count) {
+    stopPrefetch();
+    if (count > DIRCACHE_SIZE) {
+        count = DIRCACHE_SIZE;
+    }
+    for (int i = 0; i < count; i++) {
+        prefetchPaths[i] = strdup(paths[i]);
+    }
+    prefetchCount = count;
+    atomic_store(&prefetchCancelled, 0);
+    if (pthread_create(&prefetchThread, NULL, prefetch, NULL)) {
+        stopPrefetch();
+        return 1;
+    }
+    prefetchRunning = 1;
+    return 0;
+}
+
+/*
+ * Function: dirCache_clear
+ * ----------------------------
+ *   Stop the prefetch thread and free every cached listing.
+ */
+void dirCache_clear() {
+    stopPrefetch();
+    pthread_mutex_lock(&cacheLock);
+    for (int i = 0; i < DIRCACHE_SIZE; i++) {
+        freeListing(&cache[i]);
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/*
+ * Function: findListing
+ * ----------------------------
+ *   Return the cached listing of a directory if it is still up to date.
+ *   Must be called with cacheLock held.
+ *
+ *   path: path of the directory
+ *   status: current status of the directory
+ *
+ *   return: the listing. NULL if the directory is not cached or was modified since.
+ */
+static struct directoryListing* findListing(const char* path, const struct stat* status) {
+    for (int i = 0; i < DIRCACHE_SIZE; i++) {
+        if (cache[i].path != NULL && !strcmp(cache[i].path, path)) {
+            if (cache[i].modified.tv_sec != status->st_mtim.tv_sec
+                || cache[i].modified.tv_nsec != status->st_mtim.tv_nsec) {
+                return NULL;
+            }
+            return &cache[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Function: storeListing
+ * ----------------------------
+ *   Move a listing into the cache. It replaces the listing of the same directory if
+ *   there is one, the least recently used listing otherwise.
+ *   Must be called with cacheLock held.
+ *
+ *   newListing: a listing read by readDirectory(). Emptied by the call.
+ *
+ *   return: the listing in the cache
+ */
+static struct directoryListing* storeListing(struct directoryListing* newListing) {
+    struct directoryListing* listing = &cache[0];
+    for (int i = 0; i < DIRCACHE_SIZE; i++) {
+        if (cache[i].path != NULL && !strcmp(cache[i].path, newListing->path)) {
+            listing = &cache[i];
+            break;
+        }
+        if (cache[i].lastUse < listing->lastUse) {
+            listing = &cache[i];
+        }
+    }
+    freeListing(listing);
+    *listing = *newListing;
+    listing->lastUse = ++cacheClock;
+    memset(newListing, 0, sizeof(struct directoryListing));
+    return listing;
+}
+
+/*
+ * Function: prefetch
+ * ----------------------------
+ *   Body of the prefetch thread. Read every directory of prefetchPaths[] that is
+ *   not cached yet, until all are read or the prefetch is cancelled.
+ */
+static void* prefetch(void* arguments) {
+    for (int i = 0; i < prefetchCount && !atomic_load(&prefetchCancelled); i++) {
+        struct stat status;
+        if (stat(prefetchPaths[i], &status) || !S_ISDIR(status.st_mode)) {
+            continue;
+        }
+        pthread_mutex_lock(&cacheLock);
+        int cached = (findListing(prefetchPaths[i], &status) != NULL);
+        pthread_mutex_unlock(&cacheLock);
+        if (cached) {
+            continue;
+        }
+
+        struct directoryListing newListing = {0};
+        if (readDirectory(&newListing, prefetchPaths[i])) {
+            continue;
+        }
+        newListing.modified = status.st_mtim;
+        pthread_mutex_lock(&cacheLock);
+        //the shell may have read the directory in the meantime
+        if (findListing(prefetchPaths[i], &status) == NULL) {
+            storeListing(&newListing);
+        }
+        pthread_mutex_unlock(&cacheLock);
+        freeListing(&newListing);
+    }
+    return NULL;
+}
+
+/*
+ * Function: stopPrefetch
+ * ----------------------------
+ *   Cancel the prefetch thread, wait for it to stop and free its paths.
+ *   The directory it is reading, if any, is read to the end first.
+ */
+static void stopPrefetch() {
+    if (prefetchRunning) {
+        atomic_store(&prefetchCancelled, 1);
+        pthread_join(prefetchThread, NULL);
+        prefetchRunning = 0;
+    }
+    for (int i = 0; i < prefetchCount; i++) {
+        free(prefetchPaths[i]);
+    }
+    prefetchCount = 0;
+}
+
+/*
+ * Function: readDirectory
+ * ----------------------------
+ *   Read every entry of a directory into a listing and sort them.
+ *   Names are copied one after the other into the listing storage, and only
+ *   pointed to once the directory has been read, since the storage can move while it grows.
+ *
+ *   listing: an empty listing
+ *   path: path of the directory
+ *
+ *   return: 0 if the directory was read. 1 if it could not be opened.
+ */
+static int readDirectory(struct directoryListing* listing, const char* path) {
+    DIR* directory = opendir(path);
+    if (directory == NULL) {
+        return 1;
+    }
+
+    size_t* offsets = (size_t*) malloc(sizeof(size_t) * LISTING_INITIAL_SIZE);
+    int offsetsCapacity = LISTING_INITIAL_SIZE;
+    size_t storageLength = 0, storageCapacity = STORAGE_INITIAL_SIZE;
+    listing->storage = (char*) malloc(storageCapacity);
+    listing->size = 0;
+
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        int isDirectory = (entry->d_type == DT_DIR);
+        //add / to directory entries in order to make autocomplete more usable
+        while (storageLength + length + isDirectory + 1 > storageCapacity) {
+            storageCapacity *= 2;
+            listing->storage = (char*) realloc(listing->storage, storageCapacity);
+        }
+        if (listing->size == offsetsCapacity) {
+            offsetsCapacity *= 2;
+            offsets = (size_t*) realloc(offsets, sizeof(size_t) * offsetsCapacity);
+        }
+        offsets[listing->size++] = storageLength;
+        memcpy(listing->storage + storageLength, entry->d_name, length);
+        storageLength += length;
+        if (isDirectory) {
+            listing->storage[storageLength++] = '/';
+        }
+        listing->storage[storageLength++] = '\0';
+    }
+    closedir(directory);
+
+    listing->names = (char**) malloc(sizeof(char*) * (listing->size > 0 ? listing->size : 1));
+    for (int i = 0; i < listing->size; i++) {
+        listing->names[i] = listing->storage + offsets[i];
+    }
+    free(offsets);
+    qsort(listing->names, listing->size, sizeof(char*), compareNames);
+    listing->path = strdup(path);
+    return 0;
+}
+
+/*
+ * Function: freeListing
+ * ----------------------------
+ *   Free the memory used by a listing and mark it as unused.
+ *
+ *   listing: the listing to free
+ */
+static void freeListing(struct directoryListing* listing) {
+    free(listing->path);
+    free(listing->names);
+    free(listing->storage);
+    listing->path = NULL;
+    listing->names = NULL;
+    listing->storage = NULL;
+    listing->size = 0;
+    listing->lastUse = 0;
+}
+
+/*
+ * Function: compareNames
+ * ----------------------------
+ *   qsort() comparison function for entry names.
+ */
+static int compareNames(const void* a, const void* b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef DIRCACHE_HEADER
+    #define DIRCACHE_HEADER
+    #include <time.h>
+
+    #define DIRCACHE_SIZE 8     //number of directories whose listing is kept
+
+    /*
+     * Sorted list of the entries of a directory. Directory names end with '/'.
+     * Listings belong to the directory cache and are only valid until dirCache_release() is called.
+    */
+    struct directoryListing {
+        char* path;
+        struct timespec modified;   //modification time of the directory when it was read
+        char** names;               //entry names, sorted with strcmp
+        int size;
+        char* storage;              //every name, NUL terminated, one after the other
+        unsigned long lastUse;      //value of the cache clock when the listing was last returned
+    };
+
+    /*
+    * Function: dirCache_get
+    * ----------------------------
+    *   Return the listing of a directory. The directory is only read again
+    *   if it was modified since it was cached.
+    *   The cache stays locked until dirCache_release() is called.
+    *
+    *   path: path of the directory
+    *
+    *   return: the listing of the directory. NULL if the directory could not be opened,
+    *           in which case the cache is not locked.
+    */
+    extern struct directoryListing* dirCache_get(const char* path);
+
+    /*
+    * Function: dirCache_release
+    * ----------------------------
+    *   Unlock the cache once the listing returned by dirCache_get() is no longer used.
+    */
+    extern void dirCache_release();
+
+    /*
+    * Function: dirCache_prefetch
+    * ----------------------------
+    *   Read directories into the cache on a background thread.
+    *   A prefetch still running is cancelled first.
+    *
+    *   paths: paths of the directories, most important first. Only the first DIRCACHE_SIZE are read.
+    *   count: number of paths
+    *
+    *   return: 0 if the prefetch thread was started. 1 otherwise.
+    */
+    extern int dirCache_prefetch(const char* paths[], int count);
+
+    /*
+    * Function: dirCache_clear
+    * ----------------------------
+    *   Stop the prefetch thread and free every cached listing.
+    */
+    extern void dirCache_clear();
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <string.h>
+#include <ctype.h>
+#include "fuzzy.h"
+
+#define SCORE_MATCH 16          //every character of the pattern found
+#define SCORE_GAP_START -3      //first character skipped between two matches
+#define SCORE_GAP_EXTENSION -1  //every other character skipped
+#define BONUS_BOUNDARY 8        //match at the start of a word
+#define BONUS_CONSECUTIVE 4     //match right after the previous one
+
+static int isWordStart(const char* text, const char* character);
+
+/*
+ * Function: fuzzy_score
+ * ----------------------------
+ *   Score how well 'text' matches 'pattern' when the characters of 'pattern'
+ *   only need to appear in 'text' in the same order, like fzf does.
+ *
+ *   Most texts do not match: each character of the pattern is first looked for with memchr(),
+ *   which libc vectorizes, so they are rejected without scoring. The end of the first match
+ *   found this way is then kept, and the pattern is matched backwards from it to find the
+ *   shortest part of the text containing it. Only that part is scored.
+ *
+ *   pattern: the characters to find
+ *   text: the text to search
+ *
+ *   return: the score, higher is better. FUZZY_NO_MATCH if 'text' does not contain
+ *           every character of 'pattern' in order.
+ */
+int fuzzy_score(const char* pattern, const char* text) {
+    int patternLength = strlen(pattern);
+    if (patternLength == 0) {
+        return 0;
+    }
+
+    //leftmost match
+    const char* end = text + strlen(text);
+    const char* matchEnd = text;
+    for (int i = 0; i < patternLength; i++) {
+        matchEnd = memchr(matchEnd, pattern[i], end - matchEnd);
+        if (matchEnd == NULL) {
+            return FUZZY_NO_MATCH;
+        }
+        matchEnd++;
+    }
+    matchEnd--;
+
+    //latest start of a match ending there. matchEnd is the last character of the pattern: only the
+    //characters before it are searched for, and the scan stops on the first one, so it never leaves the text
+    const char* matchStart = matchEnd;
+    for (int i = patternLength - 1; i > 0; ) {
+        matchStart--;
+        if (*matchStart == pattern[i - 1]) {
+            i--;
+        }
+    }
+
+    int score = 0;
+    int previousMatched = 0;
+    int inGap = 0;
+    int i = 0;
+    for (const char* character = matchStart; character <= matchEnd; character++) {
+        if (i < patternLength && *character == pattern[i]) {
+            score += SCORE_MATCH;
+            if (isWordStart(text, character)) {
+                score += BONUS_BOUNDARY;
+            }
+            if (previousMatched) {
+                score += BONUS_CONSECUTIVE;
+            }
+            previousMatched = 1;
+            inGap = 0;
+            i++;
+        } else {
+            score += inGap ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+            previousMatched = 0;
+            inGap = 1;
+        }
+    }
+    return score;
+}
+
+/*
+ * Function: isWordStart
+ * ----------------------------
+ *   Return whether a character starts a word: it is the first one of the text,
+ *   follows a separator, or is an uppercase letter following a lowercase one.
+ *
+ *   text: the text the character belongs to
+ *   character: the character
+ *
+ *   return: 1 if the character starts a word. 0 otherwise.
+ */
+static int isWordStart(const char* text, const char* character) {
+    if (character == text) {
+        return 1;
+    }
+    char previous = character[-1];
+    if (strchr("/_-. ", previous) != NULL) {
+        return 1;
+    }
+    return islower((unsigned char) previous) && isupper((unsigned char) *character);
+}
\ No newline at end of file
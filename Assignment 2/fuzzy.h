@@ -0,0 +1,23 @@
+#ifndef FUZZY_HEADER
+    #define FUZZY_HEADER
+
+    #include <limits.h>
+
+    #define FUZZY_NO_MATCH INT_MIN  //long gaps make scores negative: no score can be this low
+
+    /*
+    * Function: fuzzy_score
+    * ----------------------------
+    *   Score how well 'text' matches 'pattern' when the characters of 'pattern'
+    *   only need to appear in 'text' in the same order, like fzf does.
+    *   Matches are rewarded, more so at the start of words and when consecutive,
+    *   and gaps between them are penalized.
+    *
+    *   pattern: the characters to find
+    *   text: the text to search
+    *
+    *   return: the score, higher is better. FUZZY_NO_MATCH if 'text' does not contain
+    *           every character of 'pattern' in order.
+    */
+    extern int fuzzy_score(const char* pattern, const char* text);
+#endif
\ No newline at end of file
@@ -2,26 +2,77 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#include <dirent.h>
+#include <glob.h>
 #include "shellmemory.h"
 #include "shell.h"
 #include "terminal-io.h"
 #include "interpreter.h"
 #include "kernel.h"
+#include "stringset.h"
+#include "dircache.h"
+#include "fuzzy.h"
+#include "stats.h"
+#include "trace.h"
 
-static int tabAutocomplete_withCommand(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete);
-static char * autocompleteToken(char* token, const char* listOfTerms[], int numberOfTerms);
-int tabAutocomplete(char *string, char *tokens[], int cursorPosition);
+static int tabAutocomplete_withCommand(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete);
+static char * autocompleteToken(char* token, const char* sortedTerms[], int numberOfTerms);
+static void replaceToken(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete, const char *autocomplete);
+static int autocompleteFileName(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete);
 
 static int tokenlen(char *tokens[]);
 static int stokenlen(const char *tokens[]);
 static int validateNumberOfParameters(char *tokens[], int commandId, int expectedNumberOfParameters);
 static int validateNumberOfParameters_range(char *tokens[], int commandId, int minNumberOfParameters, int maxNumberOfParameters);
 static char* getLastOccurence(char *string, char *substring);
-static char* getLargestCommonSubstring(const char *strings[], const char *initialSubstring);
+static int findPrefix(const char *sortedTerms[], int numberOfTerms, const char *prefix, int *first);
+static size_t commonPrefixLength(const char *a, const char *b);
+static int displaySetVariable(char *var, int error, char *result);
+static int displayVariable(char *result);
+
+/*
+ * Autocomplete option and its rank. Higher scores are listed first.
+ */
+struct rankedTerm
+{
+    const char *term;
+    int score;
+};
+
+/*
+ * Hash table (linear probing) of the words of the most recent commands,
+ * with the age of the most recent command each word appears in.
+ */
+struct recentWords
+{
+    char *words[RECENT_WORDS_SIZE];
+    int ages[RECENT_WORDS_SIZE];
+    int size;
+};
+
+static int rankTerms(const char *token, const char *terms[], int numberOfTerms, int fuzzy, struct rankedTerm ranked[], int *numberRanked);
+static void printRankedTerms(struct rankedTerm ranked[], int numberRanked, int numberOfMatches);
+static void recentWords_build(struct recentWords *recent);
+static int recentWords_getAge(struct recentWords *recent, const char *term);
+static void recentWords_destroy(struct recentWords *recent);
+static unsigned long hashWord(const char *word, int length);
 static int getTokenBasedOnCursor(char *string, char *tokens[], int cursorPosition);
 static int getLocationOfToken(char *string, char *tokens[], int tokenNumber);
 
+/*
+ * Growable list of the program names passed to exec.
+ */
+struct programList
+{
+    char **names;
+    int size;
+    int capacity;
+};
+
+static void programList_add(struct programList *programs, char *name);
+static void programList_addPattern(struct programList *programs, char *pattern);
+static int programList_addManifest(struct programList *programs, char *manifest);
+static void programList_destroy(struct programList *programs);
+
 //COMMANDSET must be the last element in the enum in order for it to equal the number of commands
 static enum commandSet
 {
@@ -29,10 +80,14 @@ static enum commandSet
     ECHO,
     EXEC,
     HELP,
+    JOBS,
+    KILL,
     PRINT,
     QUIT,
     RUN,
     SET,
+    STATS,
+    WAIT,
     COMMANDSET
 } commandId;
 
@@ -45,21 +100,28 @@ static int print(char *tokens[]);
 static int run(char *tokens[]);
 static int clear(char *tokens[]);
 static int exec(char* tokens[]);
+static int jobs(char* tokens[]);
+static int killCommand(char* tokens[]);
+static int waitCommand(char* tokens[]);
+static int stats(char* tokens[]);
 
 //command autocomplete functions
-static int help_autocomplete(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete);
-static int run_autocomplete(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete);
-static int exec_autocomplete(char *string, char*tokens[], int cursorPosition, int tokenToAutocomplete);
+static int help_autocomplete(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete);
+static int run_autocomplete(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete);
+static int exec_autocomplete(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete);
 
 //array of command functions
 static const int const (*command_functions[COMMANDSET])(char *tokens[]) = 
-{[HELP] = help, [QUIT] = quit, [SET] = set, [PRINT] = print, [RUN] = run, [CLEAR] = clear, [ECHO] = echo, [EXEC] = exec};
+{[HELP] = help, [QUIT] = quit, [SET] = set, [PRINT] = print, [RUN] = run, [CLEAR] = clear, [ECHO] = echo, [EXEC] = exec,
+ [JOBS] = jobs, [KILL] = killCommand, [WAIT] = waitCommand, [STATS] = stats};
 //array of command-specific autocomplete functions
-static const int const (*command_autocompleteFunctions[COMMANDSET])(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete) = 
-{[HELP] = help_autocomplete, [QUIT] = NULL, [SET] = NULL, [PRINT] = NULL, [RUN] = run_autocomplete, [CLEAR] = NULL, [ECHO] = NULL, [EXEC] = exec_autocomplete};
-//array of command names
+static const int const (*command_autocompleteFunctions[COMMANDSET])(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete) = 
+{[HELP] = help_autocomplete, [QUIT] = NULL, [SET] = NULL, [PRINT] = NULL, [RUN] = run_autocomplete, [CLEAR] = NULL, [ECHO] = NULL, [EXEC] = exec_autocomplete,
+ [JOBS] = NULL, [KILL] = NULL, [WAIT] = NULL, [STATS] = NULL};
+//array of command names. Sorted, since commandSet is in alphabetical order
 static const char const *commands[COMMANDSET] = 
-{[HELP] = "help", [QUIT] = "quit", [SET] = "set", [PRINT] = "print", [RUN] = "run", [CLEAR] = "clear", [ECHO] = "echo", [EXEC] = "exec"};
+{[HELP] = "help", [QUIT] = "quit", [SET] = "set", [PRINT] = "print", [RUN] = "run", [CLEAR] = "clear", [ECHO] = "echo", [EXEC] = "exec",
+ [JOBS] = "jobs", [KILL] = "kill", [WAIT] = "wait", [STATS] = "stats"};
 
 
 //commands_description is used by 'help' command to display information
@@ -85,9 +147,21 @@ static const char const *commands_description[COMMANDSET * 2] = {
     [ECHO] = "echo STRING",
     [ECHO +
         COMMANDSET] = "Print STRING on a new line",
-    [EXEC]= "exec program1 [program2] [program3]",
+    [EXEC]= "exec program1 [program2] ... [&]",
     [EXEC +
-        COMMANDSET] = "run programs concurrently"};
+        COMMANDSET] = "run programs concurrently (@FILE lists programs, one per line). & runs them in the background",
+    [JOBS] = "jobs",
+    [JOBS +
+        COMMANDSET] = "Lists the processes that have not terminated",
+    [KILL] = "kill PID",
+    [KILL +
+        COMMANDSET] = "Terminates the process PID",
+    [WAIT] = "wait",
+    [WAIT +
+        COMMANDSET] = "Waits for all background processes to terminate",
+    [STATS] = "stats [FILE]",
+    [STATS +
+        COMMANDSET] = "Displays scheduler statistics of terminated processes - writes them to FILE as JSON"};
 
 /*
  * Function: interpreter
@@ -107,95 +181,352 @@ int interpreter(char *tokens[])
     }
 
     //compare first token to all known commands. If a match is found, run that command
+    TRACE_BEGIN("interpreter");
     for (int i = 0; i < COMMANDSET; i++)
     {
         if (!strcmp(commands[i], tokens[0]))
         {
-            return (*command_functions[i])(tokens);
+            TRACE_BEGIN(commands[i]);
+            int error = (*command_functions[i])(tokens);
+            TRACE_END(commands[i]);
+            TRACE_END("interpreter");
+            return error;
         }
     }
+    TRACE_END("interpreter");
 
     //no match was found
-    setColor(RED);
-    printf("Unknown command \'%s\'\n", tokens[0]);
-    setColor(DEFAULT);
+    printColor(RED, "Unknown command \'%s\'\n", tokens[0]);
     return 1;
 }
 
+/*
+ * Function: interpreter_set
+ * ----------------------------
+ *   Assign a value to a shell variable and display it. Runs the set command
+ *   once its arguments are validated.
+ *
+ *   var: name of the variable. Must not be empty
+ *   value: value to assign to the variable
+ *
+ *   returns: 0 if successful. 1 otherwise.
+ */
+int interpreter_set(char *var, char *value)
+{
+    int error = setVar(var, value);
+    return displaySetVariable(var, error, error ? NULL : getVar(var));
+}
+
+/*
+ * Function: interpreter_setSlot
+ * ----------------------------
+ *   Behaves exactly like interpreter_set, for the variable stored in 'slot'.
+ *   The name of the variable is not looked up: it is only displayed.
+ *
+ *   slot: slot of the variable, returned by internVar()
+ *   var: name of the variable
+ *   value: value to assign to the variable
+ *
+ *   returns: 0 if successful. 1 otherwise.
+ */
+int interpreter_setSlot(int slot, char *var, char *value)
+{
+    int error = setVarSlot(slot, value);
+    return displaySetVariable(var, error, error ? NULL : getVarSlot(slot));
+}
+
+/*
+ * Function: interpreter_print
+ * ----------------------------
+ *   Display the value of a shell variable. Runs the print command
+ *   once its arguments are validated.
+ *
+ *   var: name of the variable
+ *
+ *   returns: 0 if successful. 1 if the variable does not exist.
+ */
+int interpreter_print(char *var)
+{
+    return displayVariable(getVar(var));
+}
+
+/*
+ * Function: interpreter_printSlot
+ * ----------------------------
+ *   Behaves exactly like interpreter_print, for the variable stored in 'slot'.
+ *
+ *   slot: slot of the variable, returned by internVar()
+ *
+ *   returns: 0 if successful. 1 if the variable does not exist.
+ */
+int interpreter_printSlot(int slot)
+{
+    return displayVariable(getVarSlot(slot));
+}
+
+/*
+ * Function: interpreter_echo
+ * ----------------------------
+ *   Display a string on a new line. Runs the echo command
+ *   once its arguments are validated.
+ *
+ *   string: the string to display
+ *
+ *   returns: 0
+ */
+int interpreter_echo(char *string)
+{
+    printColor(BLUE, "%s\n", string);
+    return 0;
+}
+
 /*
  * Function: autocompleteToken
  * ----------------------------
  *   Attempt to autocomplete a token with terms from a specified list.
  *   Returns the resulting string.
  *
+ *   Terms starting with the token are found with two binary searches, and since
+ *   they are sorted, their largest common prefix is the one of the first and last match.
+ *   When no term starts with the token, the terms containing its characters in order
+ *   (fuzzy matches) are used instead. Listed options are ranked with rankTerms().
+ *
  *   token:         token to autocomplete
- *   listOfTerms:   list of terms that we will compare to token
- *   numberOfTerms: number of terms in listOfTerms
+ *   sortedTerms:   list of terms that we will compare to token, sorted with strcmp
+ *   numberOfTerms: number of terms in sortedTerms
  * 
  *   return: token if no autocomplete was possible. The new, autocompleted
  *   string is returned otherwise.
  */
-static char * autocompleteToken(char* token, const char* listOfTerms[], int numberOfTerms) {
-    //initialize array of autocomplete options
-    const char **autoCompleteOptions = (const char**) malloc(sizeof(char*) * numberOfTerms);
-    for (int i = 0; i < numberOfTerms; i++) {
-        autoCompleteOptions[i] = NULL;
+static char * autocompleteToken(char* token, const char* sortedTerms[], int numberOfTerms) {
+    //get all possibilities for autocomplete
+    int firstOption;
+    int foundAutocompletePossibilities = findPrefix(sortedTerms, numberOfTerms, token, &firstOption);
+    const char **autoCompleteOptions = sortedTerms + firstOption;
+
+    struct rankedTerm ranked[AUTOCOMPLETE_MAX_LISTED];
+    int numberRanked;
+    if (foundAutocompletePossibilities == 0) //no term starts with the token: look for fuzzy matches
+    {
+        int fuzzyMatches = rankTerms(token, sortedTerms, numberOfTerms, 1, ranked, &numberRanked);
+        if (fuzzyMatches == 1) {
+            return strdup(ranked[0].term);
+        }
+        if (fuzzyMatches > 1) {
+            printRankedTerms(ranked, numberRanked, fuzzyMatches);
+        }
+        return strdup(token); //return the unaltered token if no single autocomplete option found
+    }
+    if (foundAutocompletePossibilities == 1) //if only one possible command, just go ahead and autocomplete
+    {
+        return strdup(autoCompleteOptions[0]);
     }
 
-    //get all possibilities for autocomplete
-    size_t foundAutocompletePossibilities = 0;
-    int sizeOfUserToken = strlen(token);
-    for (size_t currentTerm = 0; currentTerm < numberOfTerms; currentTerm++)
+    //if multiple possibilities, autocomplete as much as possible (largest common prefix)
+    size_t largestCommonPrefix = commonPrefixLength(autoCompleteOptions[0], autoCompleteOptions[foundAutocompletePossibilities - 1]);
+    if (largestCommonPrefix == strlen(token)) //nothing to add: print them on screen
+    {
+        rankTerms(token, autoCompleteOptions, foundAutocompletePossibilities, 0, ranked, &numberRanked);
+        printRankedTerms(ranked, numberRanked, foundAutocompletePossibilities);
+    }
+    return strndup(autoCompleteOptions[0], largestCommonPrefix);
+}
+
+/*
+ * Function: rankTerms
+ * ----------------------------
+ *   Find the best autocomplete options among a list of terms.
+ *   A term is ranked by its fuzzy_score() against the token, plus up to RECENT_BONUS if it
+ *   appears in one of the last RECENT_HISTORY commands, more the more recent the command is.
+ *   Only the best AUTOCOMPLETE_MAX_LISTED terms are kept, sorted by insertion:
+ *   a term is only inserted if it beats the worst one kept, so most terms cost a single comparison.
+ *   Terms with the same score stay in the order of the list.
+ *
+ *   token:         token to autocomplete
+ *   terms:         list of terms to rank
+ *   numberOfTerms: number of terms in terms
+ *   fuzzy:         1 to only keep the terms containing the characters of token in order.
+ *                  0 if every term is an option (terms already start with token).
+ *   ranked:        set to the best options, best first. Holds AUTOCOMPLETE_MAX_LISTED terms.
+ *   numberRanked:  set to the number of terms in ranked
+ *
+ *   returns: the number of options found
+ */
+static int rankTerms(const char *token, const char *terms[], int numberOfTerms, int fuzzy, struct rankedTerm ranked[], int *numberRanked)
+{
+    struct recentWords recent;
+    recentWords_build(&recent);
+
+    int numberOfOptions = 0;
+    *numberRanked = 0;
+    for (int i = 0; i < numberOfTerms; i++)
     {
-        if (strstr(listOfTerms[currentTerm], token) == listOfTerms[currentTerm])
+        int score = 0;
+        if (fuzzy)
+        {
+            score = fuzzy_score(token, terms[i]);
+            if (score == FUZZY_NO_MATCH) {
+                continue;
+            }
+        }
+        numberOfOptions++;
+        if (recent.size > 0)
         {
-            autoCompleteOptions[foundAutocompletePossibilities++] = listOfTerms[currentTerm];
+            int age = recentWords_getAge(&recent, terms[i]);
+            if (age >= 0) {
+                score += RECENT_BONUS * (RECENT_HISTORY - age) / RECENT_HISTORY;
+            }
+        }
+
+        if (*numberRanked == AUTOCOMPLETE_MAX_LISTED)
+        {
+            if (score <= ranked[AUTOCOMPLETE_MAX_LISTED - 1].score) {
+                continue;
+            }
+            (*numberRanked)--;
+        }
+        int position = (*numberRanked)++;
+        while (position > 0 && ranked[position - 1].score < score)
+        {
+            ranked[position] = ranked[position - 1];
+            position--;
         }
+        ranked[position].term = terms[i];
+        ranked[position].score = score;
     }
 
-    if (foundAutocompletePossibilities > 0)
+    recentWords_destroy(&recent);
+    return numberOfOptions;
+}
+
+/*
+ * Function: printRankedTerms
+ * ----------------------------
+ *   Print autocomplete options, ITEMS_PER_LINE per line, followed by the number
+ *   of options that were not ranked high enough to be printed.
+ *
+ *   ranked:          options to print, best first
+ *   numberRanked:    number of options in ranked
+ *   numberOfMatches: number of options found
+ */
+static void printRankedTerms(struct rankedTerm ranked[], int numberRanked, int numberOfMatches)
+{
+    putchar('\n');
+    int counter = 0;
+    while (counter < numberRanked)
     {
-        if (foundAutocompletePossibilities == 1) //if only one possible command, just go ahead and autocomplete
-        {
-            char* autocompletedToken = strdup(autoCompleteOptions[0]);
-            free(autoCompleteOptions);
-            return autocompletedToken;
+        printf("%s    ", ranked[counter++].term);
+        if (counter % ITEMS_PER_LINE == 0) {
+            putchar('\n');
         }
-        else //if multiple possibilities, print them on screen
+    }
+    if (counter % ITEMS_PER_LINE != 0) {
+        putchar('\n');
+    }
+    if (numberOfMatches > numberRanked) {
+        printf("... and %d more\n", numberOfMatches - numberRanked);
+    }
+}
+
+/*
+ * Function: recentWords_build
+ * ----------------------------
+ *   Store the words of the last RECENT_HISTORY commands. Paths are split on /,
+ *   so the file name of a script is found as it is listed in its directory.
+ *   Words are no longer added once the table is half full.
+ *
+ *   recent: the table to fill
+ */
+static void recentWords_build(struct recentWords *recent)
+{
+    memset(recent->words, 0, sizeof(recent->words));
+    recent->size = 0;
+    for (int age = 0; age < RECENT_HISTORY && recent->size < RECENT_WORDS_SIZE / 2; age++)
+    {
+        char *command = history_getRecent(age);
+        if (command == NULL) {
+            break;
+        }
+        command = strdup(command);
+        char *savePointer;
+        for (char *word = strtok_r(command, " \"/", &savePointer);
+             word != NULL && recent->size < RECENT_WORDS_SIZE / 2;
+             word = strtok_r(NULL, " \"/", &savePointer))
         {
-            int alreadyLargestCommonString = 1;
-            char *largestCommonString = NULL;
-            if (strlen(token))
-            {
-                largestCommonString = getLargestCommonSubstring(autoCompleteOptions, token);    //autocomplete as much as possible (largest common substring)
-                alreadyLargestCommonString = (strlen(largestCommonString) == strlen(token));
-            } else {
-                largestCommonString = strdup("");
+            if (!strcmp(word, ".") || !strcmp(word, "..")) {
+                continue;   //part of most paths, not a choice of the user
+            }
+            //a word seen in a more recent command keeps its age
+            int length = strlen(word);
+            int slot = hashWord(word, length) & (RECENT_WORDS_SIZE - 1);
+            while (recent->words[slot] != NULL && strcmp(recent->words[slot], word)) {
+                slot = (slot + 1) & (RECENT_WORDS_SIZE - 1);
             }
-            if (alreadyLargestCommonString)
+            if (recent->words[slot] == NULL)
             {
-                putchar('\n');
-                size_t counter = 0;
-                while (counter < foundAutocompletePossibilities)
-                {
-                    printf("%s    ", autoCompleteOptions[counter++]);
-                    if (counter % ITEMS_PER_LINE == 0) {
-                        putchar('\n');
-                    }
-                }
-                if (counter % ITEMS_PER_LINE != 0) {
-                    putchar('\n');
-                }
-                
+                recent->words[slot] = strdup(word);
+                recent->ages[slot] = age;
+                recent->size++;
             }
-            free(autoCompleteOptions);
-            return largestCommonString;
         }
+        free(command);
+    }
+}
+
+/*
+ * Function: recentWords_getAge
+ * ----------------------------
+ *   Return the age of the most recent command containing a term.
+ *   The / ending directory names is ignored.
+ *
+ *   recent: the table of recent words
+ *   term:   the term to look for
+ *
+ *   returns: the number of commands entered after the one containing term. -1 if term is not recent.
+ */
+static int recentWords_getAge(struct recentWords *recent, const char *term)
+{
+    int length = strlen(term);
+    if (length > 0 && term[length - 1] == '/') {
+        length--;
+    }
+    int slot = hashWord(term, length) & (RECENT_WORDS_SIZE - 1);
+    while (recent->words[slot] != NULL)
+    {
+        if (!strncmp(recent->words[slot], term, length) && recent->words[slot][length] == '\0') {
+            return recent->ages[slot];
+        }
+        slot = (slot + 1) & (RECENT_WORDS_SIZE - 1);
+    }
+    return -1;
+}
+
+/*
+ * Function: recentWords_destroy
+ * ----------------------------
+ *   Free the words stored in the table.
+ *
+ *   recent: the table to destroy
+ */
+static void recentWords_destroy(struct recentWords *recent)
+{
+    for (int i = 0; i < RECENT_WORDS_SIZE; i++) {
+        free(recent->words[i]);
     }
+}
 
-    //return the unaltered token if no autocomplete option found
-    free(autoCompleteOptions);
-    return strdup(token);
+/*
+ * Function: hashWord
+ * ----------------------------
+ *   Return the djb2 hash of the first 'length' characters of word.
+ */
+static unsigned long hashWord(const char *word, int length)
+{
+    unsigned long hash = 5381;
+    for (int i = 0; i < length; i++) {
+        hash = ((hash << 5) + hash) + (unsigned char) word[i];
+    }
+    return hash;
 }
 
 
@@ -205,14 +536,13 @@ static char * autocompleteToken(char* token, const char* listOfTerms[], int numb
  *   check to see if first user token is a valid command.
  *   if it is, run the command specific autocomplete function.
  *      
+ *   terminalLine: the user command, edited in place
  *   tokens: user command in tokenized form
- *   string: unparsed user command
- *   cursorPosition: position of cursor relative to beginning of string
  *   tokenToAutocomplete: the index of the token the user is attempting to autocomplete
  * 
- *   return: how many characters we should move the cursor by to get to the end of the token that was autocompleted.
+ *   return: 0 if the command specific autocomplete function ran without error. 1 otherwise.
  */
-static int tabAutocomplete_withCommand(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete)
+static int tabAutocomplete_withCommand(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete)
 {
     //compare first token to all known commands. If a match is found, run that command
     for (int i = 0; i < COMMANDSET; i++)
@@ -221,7 +551,7 @@ static int tabAutocomplete_withCommand(char *string, char *tokens[], int cursorP
         {
             if (command_autocompleteFunctions[i] != NULL)
             {
-                return (*command_autocompleteFunctions[i])(string, tokens, cursorPosition, tokenToAutocomplete);
+                return (*command_autocompleteFunctions[i])(terminalLine, tokens, tokenToAutocomplete);
             }
             return 0;
         }
@@ -236,38 +566,26 @@ static int tabAutocomplete_withCommand(char *string, char *tokens[], int cursorP
  *   Calls tabAutocomplete_withCommand if user 
  *   is attempting to autocomplete a command specific parameter
  * 
+ *   terminalLine: the user command. The autocompleted token is replaced in place
+ *                 and the cursor is moved to its end.
  *   tokens: user command in tokenized form
- *   string: unparsed user command
- *   cursorPosition: position of cursor relative to beginning of string
  * 
- *   return: how many characters we should move the cursor by to get to the end of the token that was autocompleted.
+ *   return: 0 if the autocomplete ran without error. 1 otherwise.
  */
-int tabAutocomplete(char *string, char *tokens[], int cursorPosition)
+int tabAutocomplete(TERMINAL_LINE *terminalLine, char *tokens[])
 {
-    int tokenToAutocomplete = getTokenBasedOnCursor(string, tokens, cursorPosition);
+    int tokenToAutocomplete = getTokenBasedOnCursor(terminalLine_getString(terminalLine), tokens, terminalLine->cursorPosition);
 
     //if user has input more than one token, run a command specific autocomplete
     if (tokens != NULL && (tokenlen(tokens) > 1))
     {
-        return tabAutocomplete_withCommand(string, tokens, cursorPosition, tokenToAutocomplete);
+        return tabAutocomplete_withCommand(terminalLine, tokens, tokenToAutocomplete);
     }
     
     char* autocomplete = autocompleteToken(tokens[tokenToAutocomplete], commands, COMMANDSET);
-    int tokenPosition = cursorPosition;
-    if (strlen(tokens[tokenToAutocomplete]) != 0) {
-        tokenPosition = getLocationOfToken(string, tokens, tokenToAutocomplete);
-    }
-
-    //alter user string to reflect autocomplete changes
-    int moveCursorBy = 0;
-    char test[500] = "";
-    strncpy(test, string, tokenPosition);
-    strcat(test, autocomplete);
-    moveCursorBy = strlen(test) - cursorPosition;
-    strcat(test, (string+tokenPosition+strlen(tokens[tokenToAutocomplete])));
-    strcpy(string, test);
+    replaceToken(terminalLine, tokens, tokenToAutocomplete, autocomplete);
     free(autocomplete);
-    return moveCursorBy;
+    return 0;
 }
 
 
@@ -277,14 +595,13 @@ int tabAutocomplete(char *string, char *tokens[], int cursorPosition)
  *   attempt to autocomplete the second parameter of 'help'.
  *   autocomplete in exactly the same way as tabAutocomplete()
  *      
+ *   terminalLine: the user command, edited in place
  *   tokens: user command in tokenized form
- *   string: unparsed user command
- *   cursorPosition: position of cursor relative to beginning of string
  *   tokenToAutocomplete: the index of the token the user is attempting to autocomplete
  * 
- *   return: how many characters we should move the cursor by to get to the end of the token that was autocompleted.
+ *   return: 0 if the autocomplete ran without error. 1 otherwise.
  */
-static int help_autocomplete(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete)
+static int help_autocomplete(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete)
 {
     int numberOfTokens = tokenlen(tokens);
     if (numberOfTokens > 2) {
@@ -292,21 +609,96 @@ static int help_autocomplete(char *string, char *tokens[], int cursorPosition, i
     }
 
     char* autocomplete = autocompleteToken(tokens[tokenToAutocomplete], commands, COMMANDSET);
-    int tokenPosition = cursorPosition;
+    replaceToken(terminalLine, tokens, tokenToAutocomplete, autocomplete);
+    free(autocomplete);
+    return 0;
+}
+
+/*
+ * Function: replaceToken
+ * ----------------------------
+ *   Replace a token of the user command with its autocompleted version
+ *   and move the cursor to the end of it.
+ *
+ *   terminalLine: the user command, edited in place
+ *   tokens: user command in tokenized form
+ *   tokenToAutocomplete: the index of the token to replace
+ *   autocomplete: the autocompleted token
+ */
+static void replaceToken(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete, const char *autocomplete)
+{
+    int tokenPosition = terminalLine->cursorPosition;
     if (strlen(tokens[tokenToAutocomplete]) != 0) {
-        tokenPosition = getLocationOfToken(string, tokens, tokenToAutocomplete);
+        tokenPosition = getLocationOfToken(terminalLine_getString(terminalLine), tokens, tokenToAutocomplete);
     }
+    terminalLine_replace(terminalLine, tokenPosition, strlen(tokens[tokenToAutocomplete]), autocomplete);
+    terminalLine_setCursor(terminalLine, tokenPosition + strlen(autocomplete));
+}
 
-    //alter user string to reflect autocomplete changes
-    int moveCursorBy = 0;
-    char test[500] = "";
-    strncpy(test, string, tokenPosition);
-    strcat(test, autocomplete);
-    moveCursorBy = strlen(test) - cursorPosition;
-    strcat(test, (string+tokenPosition+strlen(tokens[tokenToAutocomplete])));
-    strcpy(string, test);
+/*
+ * Function: autocompleteFileName
+ * ----------------------------
+ *   Autocomplete a token with the names of the files located in the directory it refers to.
+ *   The token is quoted, and starts with ./ if it did not contain a directory.
+ *
+ *   terminalLine: the user command, edited in place
+ *   tokens: user command in tokenized form
+ *   tokenToAutocomplete: the index of the token the user is attempting to autocomplete
+ *
+ *   return: 0 if the autocomplete ran without error. 1 if the directory could not be opened.
+ */
+static int autocompleteFileName(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete)
+{
+    char *token = tokens[tokenToAutocomplete];
+    char *fileNameOffset = token;
+
+    //the part of the token up to its last / is the directory to look into
+    char *lastSlash = strrchr(token, '/');
+    if (lastSlash != NULL)
+    {
+        fileNameOffset = lastSlash + 1;
+    }
+    int directoryLength = fileNameOffset - token;
+    char *directory = (char*) malloc(directoryLength + 3);
+    strcpy(directory, "./");
+    strncat(directory, token, directoryLength);
+
+    //the listing is cached and only read again if the directory was modified
+    struct directoryListing *listing = dirCache_get(directory);
+    free(directory);
+    if (listing == NULL)
+    {
+        printColor(RED, "\nDirectory not found\n");
+        return 1;
+    }
+    char* autocomplete = autocompleteToken(fileNameOffset, (const char**) listing->names, listing->size);
+    dirCache_release();
+
+    char *string = terminalLine_getString(terminalLine);
+    int tokenPosition = terminalLine->cursorPosition;
+    if (strlen(token) != 0) {
+        tokenPosition = getLocationOfToken(string, tokens, tokenToAutocomplete);
+    }
+    int tokenEnd = tokenPosition + strlen(token);
+    int addOpeningQuote = (tokenPosition != 0 && string[tokenPosition - 1] != '\"');
+    int addClosingQuote = (string[tokenEnd] != '\"');
+    int addDirectory = !(token[0] == '.' && token[1] == '/');
+
+    //alter user string to reflect autocomplete changes. Edit from the end of the token
+    //to its start so the positions found in string stay valid
+    if (addClosingQuote) {
+        terminalLine_replace(terminalLine, tokenEnd, 0, "\"");
+    }
+    terminalLine_replace(terminalLine, tokenPosition + directoryLength, strlen(fileNameOffset), autocomplete);
+    if (addDirectory) {
+        terminalLine_replace(terminalLine, tokenPosition, 0, "./");
+    }
+    if (addOpeningQuote) {
+        terminalLine_replace(terminalLine, tokenPosition, 0, "\"");
+    }
+    terminalLine_setCursor(terminalLine, tokenPosition + addOpeningQuote + 2 * addDirectory + directoryLength + strlen(autocomplete));
     free(autocomplete);
-    return moveCursorBy;
+    return 0;
 }
 
 /*
@@ -348,9 +740,7 @@ static int help(char *tokens[])
             }
         }
         //no match was found
-        setColor(RED);
-        printf("Unknown command \'%s\'\n", tokens[1]);
-        setColor(DEFAULT);
+        printColor(RED, "Unknown command \'%s\'\n", tokens[1]);
         return 1;
     }
 }
@@ -396,31 +786,11 @@ static int set(char *tokens[])
     }
     if (strlen(tokens[1]) == 0)
     { //do not save variable, it is illegal for VAR to be empty
-        setColor(RED);
-        puts("Variable name cannot be empty");
-        setColor(DEFAULT);
+        printColor(RED, "Variable name cannot be empty\n");
         return 1;
     }
 
-    int error = setVar(tokens[1], tokens[2]);
-    if (error)
-    {
-        setColor(RED);
-        puts("Error saving variable: memory is full");
-        setColor(DEFAULT);
-        return 1;
-    }
-    char *result = getVar(tokens[1]);
-    if (!result)
-    {
-        setColor(RED);
-        puts("Error retrieving variable. Please try saving again");
-        setColor(DEFAULT);
-        return 1;
-    }
-    printf("%s = %s\n", tokens[1], result);
-    free(result);
-    return 0;
+    return interpreter_set(tokens[1], tokens[2]);
 }
 
 /*
@@ -439,17 +809,7 @@ static int print(char *tokens[])
     {
         return 1;
     }
-    char *result = getVar(tokens[1]);
-    if (!result)
-    {
-        setColor(RED);
-        puts("Variable does not exist");
-        setColor(DEFAULT);
-        return 1;
-    }
-    printf("%s\n", result);
-    free(result);
-    return 0;
+    return interpreter_print(tokens[1]);
 }
 
 /*
@@ -468,10 +828,63 @@ static int echo(char *tokens[])
     {
         return 1;
     }
-    setColor(BLUE);
-    printf("%s\n", tokens[1]);
-    setColor(DEFAULT);
-    return 0;
+    return interpreter_echo(tokens[1]);
+}
+
+/*
+ * Function: autocomplete_prefetch
+ * ----------------------------
+ *   Start reading, on a background thread, the directories file names are most likely
+ *   to be autocompleted in: the current directory, then the directories of the scripts
+ *   passed to run and exec by the most recent commands of the history.
+ */
+void autocomplete_prefetch()
+{
+    //paths are built like autocompleteFileName() builds them, so they match the cached listings
+    char *paths[DIRCACHE_SIZE];
+    int numberOfPaths = 0;
+    paths[numberOfPaths++] = strdup("./");
+
+    for (int age = 0; age < PREFETCH_HISTORY && numberOfPaths < DIRCACHE_SIZE; age++)
+    {
+        char *command = history_getRecent(age);
+        if (command == NULL) {
+            break;
+        }
+        command = strdup(command);
+        char *savePointer;
+        char *word = strtok_r(command, " \"", &savePointer);
+        if (word != NULL && (!strcmp(word, commands[RUN]) || !strcmp(word, commands[EXEC])))
+        {
+            while ((word = strtok_r(NULL, " \"", &savePointer)) != NULL && numberOfPaths < DIRCACHE_SIZE)
+            {
+                char *lastSlash = strrchr(word, '/');
+                if (lastSlash == NULL) {
+                    continue;   //script of the current directory
+                }
+                lastSlash[1] = '\0';
+                char *path = (char*) malloc(strlen(word) + 3);
+                strcpy(path, "./");
+                strcat(path, word);
+
+                int found = 0;
+                for (int i = 0; i < numberOfPaths && !found; i++) {
+                    found = !strcmp(paths[i], path);
+                }
+                if (found) {
+                    free(path);
+                } else {
+                    paths[numberOfPaths++] = path;
+                }
+            }
+        }
+        free(command);
+    }
+
+    dirCache_prefetch((const char**) paths, numberOfPaths);
+    for (int i = 0; i < numberOfPaths; i++) {
+        free(paths[i]);
+    }
 }
 
 /*
@@ -480,95 +893,19 @@ static int echo(char *tokens[])
  *   Attempt to autocomplete the filename user is planning
  *   to run.
  *
+ *   terminalLine: the user command, edited in place
  *   tokens: user command in tokenized form
- *   string: unparsed user command
- *   cursorPosition: position of cursor relative to beginning of string
  *   tokenToAutocomplete: the index of the token the user is attempting to autocomplete
  * 
- *   return: how many characters we should move the cursor by to get to the end of the token that was autocompleted.
+ *   return: 0 if the autocomplete ran without error. 1 otherwise.
  */
-static int run_autocomplete(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete)
+static int run_autocomplete(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete)
 {
     int numberOfTokens = tokenlen(tokens);
     if (numberOfTokens > 2 || tokenToAutocomplete != 1) {
         return 0;
     }
-
-    // Get directory object
-    struct dirent *de;
-    DIR *dr;
-    
-    char *fileNameOffset = tokens[tokenToAutocomplete];
-    char directory[TOKENSIZE] = "./";
-
-    if (strlen(tokens[tokenToAutocomplete]) == 0)
-    {
-        dr = opendir(directory);
-    }
-    else
-    {
-        if (strstr(tokens[tokenToAutocomplete], "/") == NULL)
-        {
-            dr = opendir(directory);
-        }
-        else
-        {
-            strcat(directory, tokens[tokenToAutocomplete]);
-            *(getLastOccurence(directory, "/") + 1) = '\0';
-            dr = opendir(directory);
-            fileNameOffset = (tokens[tokenToAutocomplete] + strlen(directory) - 2);
-        }
-    }
-
-    if (dr == NULL) // opendir returns NULL if couldn't open directory
-    {
-        setColor(RED);
-        printf("\nDirectory not found\n");
-        setColor(DEFAULT);
-        return 0;
-    }
-
-    //store names of all files + directories in array
-    char *files[NUM_FILES] = {NULL};
-    int numberOfFiles = 0;
-    while ((de = readdir(dr)) != NULL)
-    {
-        files[numberOfFiles] = strdup(de->d_name);
-        if (de->d_type == 4)
-        {
-            strcat(files[numberOfFiles], "/");  //add / to directory entries in order to make autocomplete more usable
-        }
-        numberOfFiles++;
-    }
-    closedir(dr);
-
-    char* autocomplete = autocompleteToken(fileNameOffset, (const char**) files, numberOfFiles);
-    int tokenPosition = cursorPosition;
-    if (strlen(tokens[tokenToAutocomplete]) != 0) {
-        tokenPosition = getLocationOfToken(string, tokens, tokenToAutocomplete);
-    }
-
-    //alter user string to reflect autocomplete changes
-    int moveCursorBy = 0;
-    char test[500] = "";
-    strncpy(test, string, tokenPosition);
-    if (tokenPosition != 0 && string[tokenPosition - 1] != '\"') {
-        strcat(test, "\"");
-    }
-    if ((strlen(tokens[tokenToAutocomplete]) >= 2 && tokens[tokenToAutocomplete][0] == '.' && tokens[tokenToAutocomplete][1] == '/')) {
-        strcat(test, (directory+2));
-    } else {
-        strcat(test, directory);
-    }
-    strcat(test, autocomplete);
-    moveCursorBy = strlen(test) - cursorPosition;
-    if (*(string+tokenPosition+strlen(tokens[tokenToAutocomplete])) != '\"') {
-        strcat(test, "\"");
-    }
-    strcat(test, (string+tokenPosition+strlen(tokens[tokenToAutocomplete])));
-    strcpy(string, test);
-    free(autocomplete);
-    return moveCursorBy;
+    return autocompleteFileName(terminalLine, tokens, tokenToAutocomplete);
 }
 
 /*
@@ -592,18 +929,13 @@ static int run(char *tokens[])
     script = fopen(tokens[1], "r");
     if (!script)
     {
-        setColor(RED);
-        printf("run: Script \'%s\' not found\n", tokens[1]);
-        setColor(DEFAULT);
+        printColor(RED, "run: Script \'%s\' not found\n", tokens[1]);
         return 1;
     }
 
     char *scriptTokens[NUM_TOKENS] = {NULL};
     TERMINAL_LINE terminalLine;
-    terminalLine.string = (char *)malloc(sizeof(char) * LINESIZE);
-    strcpy(terminalLine.string, "");
-    terminalLine.cursorPosition = 0;
-    terminalLine.inputStream = script;
+    terminalLine_init(&terminalLine, script);
 
     int flag = 0;
     int error = 0;
@@ -611,7 +943,7 @@ static int run(char *tokens[])
     while (1)
     {
         //get user input
-        error = getLine(&terminalLine, LINESIZE, 0);
+        error = getLine(&terminalLine, 0);
 
         if (error == -1)
         {
@@ -620,7 +952,7 @@ static int run(char *tokens[])
         }
 
         //process user input
-        error = parse(terminalLine.string, ' ', scriptTokens);
+        error = parse(terminalLine_getString(&terminalLine), ' ', scriptTokens);
         if (!error)
         {
             error = interpreter(scriptTokens);
@@ -638,20 +970,17 @@ static int run(char *tokens[])
             for (int i = 0; i < error; i++) {
                 printf("  ");
             }
-            setColor(YELLOW);
-            printf("at \'%s\':line %d: %s\n", tokens[1], lineNumber, terminalLine.string);
-            setColor(DEFAULT);
+            printColor(YELLOW, "at \'%s\':line %d: %s\n", tokens[1], lineNumber, terminalLine_getString(&terminalLine));
             error++; //increment error to let caller function know how deep the error stack is
             break;
         }
 
-        terminalLine.string[0] = '\0';
-        terminalLine.cursorPosition = 0;
+        terminalLine_setString(&terminalLine, "");
         lineNumber++;
         tokens_destroy(scriptTokens);
     }
     fclose(script);
-    free(terminalLine.string);
+    terminalLine_destroy(&terminalLine);
     tokens_destroy(scriptTokens);
     return error;
 }
@@ -678,174 +1007,260 @@ static int clear(char *tokens[])
 /*
  * Function: exec
  * ----------------------------
- *   Execute multiple scripts concurrently (3 at most).
+ *   Execute multiple scripts concurrently.
+ *   A parameter can be a script, a glob pattern (script*.txt) or
+ *   @FILE, where FILE lists one script (or glob pattern) per line.
  *   Scripts with the same name cannot be run at the same time.
+ *   Scripts that do not fit in RAM yet wait for running scripts to end.
+ *   If the last parameter is &, the scripts run in the background.
  *
  *   tokens: user command in tokenized form
  *
  *   returns: 1 if an error is encountered. 0 otherwise.
  */
 static int exec(char* tokens[]) {
-    if (!validateNumberOfParameters_range(tokens, EXEC, 2, 4)) {
+    int numberOfTokens = tokenlen(tokens);
+    int runInBackground = (numberOfTokens > 1 && !strcmp(tokens[numberOfTokens - 1], "&"));
+    if (runInBackground) {
+        numberOfTokens--;
+    }
+    if (numberOfTokens < 2) {
+        validateNumberOfParameters_range(tokens, EXEC, 2, NUM_TOKENS);
         return 1;
     }
-    //check that none of the scripts we want to run have the same file name. Files with the
-    //same name stored in different directories will be treated as if they were the same files.
-    char* program1 = getLastOccurence(tokens[1], "/");
-    if (program1 == NULL) {
-        program1 = tokens[1];
-    } else {
-        program1++;
-    }
-    char* program2 = getLastOccurence(tokens[2], "/");
-    if (program2 == NULL) {
-        program2 = tokens[2];
-    } else {
-        program2++;
-    }
-    char* program3 = getLastOccurence(tokens[3], "/");
-    if (program3 == NULL) {
-        program3 = tokens[3];
-    } else {
-        program3++;
-    }
-    if (tokens[2]) {
-        if (strcmp(program1, program2) == 0) {
-            setColor(RED);
-            printf("Error: Script \'%s\' already loaded\n", tokens[2]);
-            setColor(DEFAULT);
-            return 1;
+
+    struct programList programs = {NULL, 0, 0};
+    for (int i = 1; i < numberOfTokens; i++) {
+        if (tokens[i][0] == '@') {
+            if (programList_addManifest(&programs, tokens[i] + 1)) {
+                programList_destroy(&programs);
+                return 1;
+            }
+        } else {
+            programList_addPattern(&programs, tokens[i]);
         }
     }
-    if (tokens[3]) {
-        if (strcmp(program1, program3) == 0) {
-            setColor(RED);
-            printf("Error: Script \'%s\' already loaded\n", tokens[3]);
-            setColor(DEFAULT);
-            return 1;
+
+    //check that none of the scripts we want to run have the same file name. Files with the
+    //same name stored in different directories will be treated as if they were the same files.
+    struct stringSet loadedPrograms;
+    stringSet_init(&loadedPrograms, programs.size);
+    int error = 0;
+    for (int i = 0; i < programs.size && !error; i++) {
+        char* program = getLastOccurence(programs.names[i], "/");
+        if (program == NULL) {
+            program = programs.names[i];
+        } else {
+            program++;
         }
-        if (strcmp(program2, program3) == 0) {
-            setColor(RED);
-            printf("Error: Script \'%s\' already loaded\n", tokens[2]);
-            setColor(DEFAULT);
-            return 1;
+
+        if (*program == '\0') {
+            printf("could not load program \'%s\'!\n", programs.names[i]);
+            error = 1;
+        } else if (!stringSet_add(&loadedPrograms, program)) {
+            printColor(RED, "Error: Script \'%s\' already loaded\n", programs.names[i]);
+            error = 1;
         }
     }
+    stringSet_destroy(&loadedPrograms);
 
-    //run myinit for all user parameters
-    if (tokens[1][strlen(tokens[1]) - 1] == '/' || myinit(tokens[1])) {
-        printf("could not load program1!\n");
-        return 1;
+    //programs are loaded in the background. The scheduler starts running them as soon as they are in RAM
+    if (!error) {
+        error = loadPrograms(programs.names, programs.size);
     }
-    if (tokens[2] && (tokens[2][strlen(tokens[2]) - 1] == '/' || myinit(tokens[2]))) {
-        printf("could not load program2!\n");
-        emptyReadyQueue();  //exec will not run. Should cleanup ready queue
+    programList_destroy(&programs);
+    if (error) {
         return 1;
     }
-    if (tokens[3] && (tokens[3][strlen(tokens[3]) - 1] == '/' || myinit(tokens[3]))) {
-        printf("could not load program3!\n");
-        emptyReadyQueue();  //exec will not run. Should cleanup ready queue
+
+    return runInBackground ? scheduler_background() : scheduler();
+}
+
+/*
+ * Function: jobs
+ * ----------------------------
+ *   List the processes that have not terminated.
+ *
+ *   tokens: user command in tokenized form
+ *
+ *   returns: 0 if exited with no error. 1 otherwise
+ */
+static int jobs(char* tokens[]) {
+    if (!validateNumberOfParameters(tokens, JOBS, 1)) {
         return 1;
     }
+    printJobs();
+    return 0;
+}
 
-
-    return scheduler();
+/*
+ * Function: killCommand
+ * ----------------------------
+ *   Terminate the process PID.
+ *
+ *   tokens: user command in tokenized form
+ *
+ *   returns: 0 if exited with no error. 1 otherwise
+ */
+static int killCommand(char* tokens[]) {
+    if (!validateNumberOfParameters(tokens, KILL, 2)) {
+        return 1;
+    }
+    char* end;
+    long pid = strtol(tokens[1], &end, 10);
+    if (*tokens[1] == '\0' || *end != '\0') {
+        printColor(RED, "kill: \'%s\' is not a process ID\n", tokens[1]);
+        return 1;
+    }
+    return killProcess((int) pid);
 }
 
 /*
- * Function: exec_autocomplete
+ * Function: waitCommand
  * ----------------------------
- *   Attempt to autocomplete the filenames user is planning
- *   to execute.
+ *   Wait for all background processes to terminate.
  *
  *   tokens: user command in tokenized form
- *   string: unparsed user command
- *   cursorPosition: position of cursor relative to beginning of string
- *   tokenToAutocomplete: the index of the token the user is attempting to autocomplete
+ *
+ *   returns: 0 if exited with no error. 1 otherwise
+ */
+static int waitCommand(char* tokens[]) {
+    if (!validateNumberOfParameters(tokens, WAIT, 1)) {
+        return 1;
+    }
+    return scheduler_wait();
+}
+
+/*
+ * Function: stats
+ * ----------------------------
+ *    no parameters:
+ *      print out the scheduler statistics of every terminated process
  * 
- *   return: how many characters we should move the cursor by to get to the end of the token that was autocompleted.
+ *   [FILE] parameter given:
+ *      write the scheduler statistics to FILE as JSON
+ *
+ *   tokens: user command in tokenized form
+ *
+ *   returns: 0 if exited with no error. 1 otherwise
  */
-static int exec_autocomplete(char *string, char *tokens[], int cursorPosition, int tokenToAutocomplete) {
-    int numberOfTokens = tokenlen(tokens);
-    if (numberOfTokens > 4 || tokenToAutocomplete == 0) {
+static int stats(char* tokens[]) {
+    if (!validateNumberOfParameters_range(tokens, STATS, 1, 2)) {
+        return 1;
+    }
+    if (tokenlen(tokens) == 1) {
+        stats_print();
         return 0;
     }
+    return stats_writeJSON(tokens[1]);
+}
 
-    // Get directory object
-    struct dirent *de;
-    DIR *dr;
-    
-    char *fileNameOffset = tokens[tokenToAutocomplete];
-    char directory[TOKENSIZE] = "./";
+/*
+ * Function: programList_add
+ * ----------------------------
+ *   Append a copy of name to the list of programs.
+ *
+ *   programs: the list of programs
+ *   name: the program name to append
+ */
+static void programList_add(struct programList *programs, char *name) {
+    if (programs->size == programs->capacity) {
+        programs->capacity = programs->capacity ? programs->capacity * 2 : 8;
+        programs->names = (char **) realloc(programs->names, sizeof(char *) * programs->capacity);
+    }
+    programs->names[programs->size++] = strdup(name);
+}
 
-    if (strlen(tokens[tokenToAutocomplete]) == 0)
-    {
-        dr = opendir(directory);
+/*
+ * Function: programList_addPattern
+ * ----------------------------
+ *   Append the programs matching a glob pattern to the list of programs.
+ *   A pattern that matches nothing (or that is not a pattern) is appended as is.
+ *
+ *   programs: the list of programs
+ *   pattern: a program name or a glob pattern
+ */
+static void programList_addPattern(struct programList *programs, char *pattern) {
+    glob_t matches;
+    if (strpbrk(pattern, "*?[") == NULL || glob(pattern, 0, NULL, &matches) != 0) {
+        programList_add(programs, pattern);
+        return;
     }
-    else
-    {
-        if (strstr(tokens[tokenToAutocomplete], "/") == NULL)
-        {
-            dr = opendir(directory);
-        }
-        else
-        {
-            strcat(directory, tokens[tokenToAutocomplete]);
-            *(getLastOccurence(directory, "/") + 1) = '\0';
-            dr = opendir(directory);
-            fileNameOffset = (tokens[tokenToAutocomplete] + strlen(directory) - 2);
-        }
+    for (size_t i = 0; i < matches.gl_pathc; i++) {
+        programList_add(programs, matches.gl_pathv[i]);
     }
+    globfree(&matches);
+}
 
-    if (dr == NULL) // opendir returns NULL if couldn't open directory
-    {
-        setColor(RED);
-        printf("\nDirectory not found\n");
-        setColor(DEFAULT);
-        return 0;
+/*
+ * Function: programList_addManifest
+ * ----------------------------
+ *   Append the programs listed in a manifest file to the list of programs.
+ *   The manifest lists one program (or glob pattern) per line.
+ *   Empty lines and lines starting with '#' are ignored.
+ *
+ *   programs: the list of programs
+ *   manifest: name of the manifest file
+ *
+ *   returns: 0 if successful. 1 if the manifest could not be opened.
+ */
+static int programList_addManifest(struct programList *programs, char *manifest) {
+    FILE *file = fopen(manifest, "r");
+    if (!file) {
+        printColor(RED, "exec: Manifest \'%s\' not found\n", manifest);
+        return 1;
     }
 
-    //store names of all files + directories in array
-    char *files[NUM_FILES] = {NULL};
-    int numberOfFiles = 0;
-    while ((de = readdir(dr)) != NULL)
-    {
-        files[numberOfFiles] = strdup(de->d_name);
-        if (de->d_type == 4)
-        {
-            strcat(files[numberOfFiles], "/");  //add / to directory entries in order to make autocomplete more usable
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t lineLength;
+    while ((lineLength = getline(&line, &lineCapacity, file)) != -1) {
+        while (lineLength > 0 && (line[lineLength - 1] == '\n' || line[lineLength - 1] == '\r')) {
+            line[--lineLength] = '\0';
+        }
+        if (lineLength > 0 && line[0] != '#') {
+            programList_addPattern(programs, line);
         }
-        numberOfFiles++;
     }
-    closedir(dr);
+    free(line);
+    fclose(file);
+    return 0;
+}
 
-    char* autocomplete = autocompleteToken(fileNameOffset, (const char**) files, numberOfFiles);
-    int tokenPosition = cursorPosition;
-    if (strlen(tokens[tokenToAutocomplete]) != 0) {
-        tokenPosition = getLocationOfToken(string, tokens, tokenToAutocomplete);
+/*
+ * Function: programList_destroy
+ * ----------------------------
+ *   Free the memory used by the list of programs.
+ *
+ *   programs: the list of programs
+ */
+static void programList_destroy(struct programList *programs) {
+    for (int i = 0; i < programs->size; i++) {
+        free(programs->names[i]);
     }
+    free(programs->names);
+    programs->names = NULL;
+    programs->size = 0;
+    programs->capacity = 0;
+}
 
-    //alter user string to reflect autocomplete changes
-    int moveCursorBy = 0;
-    char test[500] = "";
-    strncpy(test, string, tokenPosition);
-    if (tokenPosition != 0 && string[tokenPosition - 1] != '\"') {
-        strcat(test, "\"");
-    }
-    if ((strlen(tokens[tokenToAutocomplete]) >= 2 && tokens[tokenToAutocomplete][0] == '.' && tokens[tokenToAutocomplete][1] == '/')) {
-        strcat(test, (directory+2));
-    } else {
-        strcat(test, directory);
-    }
-    strcat(test, autocomplete);
-    moveCursorBy = strlen(test) - cursorPosition;
-    if (*(string+tokenPosition+strlen(tokens[tokenToAutocomplete])) != '\"') {
-        strcat(test, "\"");
+/*
+ * Function: exec_autocomplete
+ * ----------------------------
+ *   Attempt to autocomplete the filenames user is planning
+ *   to execute.
+ *
+ *   terminalLine: the user command, edited in place
+ *   tokens: user command in tokenized form
+ *   tokenToAutocomplete: the index of the token the user is attempting to autocomplete
+ * 
+ *   return: 0 if the autocomplete ran without error. 1 otherwise.
+ */
+static int exec_autocomplete(TERMINAL_LINE *terminalLine, char *tokens[], int tokenToAutocomplete) {
+    if (tokenToAutocomplete == 0) {
+        return 0;
     }
-    strcat(test, (string+tokenPosition+strlen(tokens[tokenToAutocomplete])));
-    strcpy(string, test);
-    free(autocomplete);
-    return moveCursorBy;
+    return autocompleteFileName(terminalLine, tokens, tokenToAutocomplete);
 }
 
 /*
@@ -867,21 +1282,17 @@ static int validateNumberOfParameters_range(char *tokens[], int commandId, int m
 {
     if (tokenlen(tokens) > maxNumberOfParameters)
     {
-        setColor(RED);
-        printf("Error: \'%s\' expected at most %d argument%s, but received %d\n", commands[commandId], maxNumberOfParameters - 1,
-               maxNumberOfParameters == 2 ? "" : "s", tokenlen(tokens) - 1);
-        printf("\'%s\' valid format:\n> %s\n", commands[commandId], commands_description[commandId]);
-        setColor(DEFAULT);
+        printColor(RED, "Error: \'%s\' expected at most %d argument%s, but received %d\n\'%s\' valid format:\n> %s\n",
+                   commands[commandId], maxNumberOfParameters - 1, maxNumberOfParameters == 2 ? "" : "s", tokenlen(tokens) - 1,
+                   commands[commandId], commands_description[commandId]);
         printf("Type \'help %s\' for more information\n", commands[commandId]);
         return 0;
     }
     if (tokenlen(tokens) < minNumberOfParameters)
     {
-        setColor(RED);
-        printf("Error: \'%s\' expected a minimum of %d argument%s, but received %d\n", commands[commandId], minNumberOfParameters - 1,
-               minNumberOfParameters == 2 ? "" : "s", tokenlen(tokens) - 1);
-        printf("\'%s\' valid format:\n> %s\n", commands[commandId], commands_description[commandId]);
-        setColor(DEFAULT);
+        printColor(RED, "Error: \'%s\' expected a minimum of %d argument%s, but received %d\n\'%s\' valid format:\n> %s\n",
+                   commands[commandId], minNumberOfParameters - 1, minNumberOfParameters == 2 ? "" : "s", tokenlen(tokens) - 1,
+                   commands[commandId], commands_description[commandId]);
         printf("Type \'help %s\' for more information\n", commands[commandId]);
         return 0;
     }
@@ -904,11 +1315,9 @@ static int validateNumberOfParameters(char *tokens[], int commandId, int expecte
 {
     if (tokenlen(tokens) != expectedNumberOfParameters)
     {
-        setColor(RED);
-        printf("Error: \'%s\' expected %d argument%s, but received %d\n", commands[commandId], expectedNumberOfParameters - 1,
-               expectedNumberOfParameters == 2 ? "" : "s", tokenlen(tokens) - 1);
-        printf("\'%s\' valid format:\n> %s\n", commands[commandId], commands_description[commandId]);
-        setColor(DEFAULT);
+        printColor(RED, "Error: \'%s\' expected %d argument%s, but received %d\n\'%s\' valid format:\n> %s\n",
+                   commands[commandId], expectedNumberOfParameters - 1, expectedNumberOfParameters == 2 ? "" : "s", tokenlen(tokens) - 1,
+                   commands[commandId], commands_description[commandId]);
         printf("Type \'help %s\' for more information\n", commands[commandId]);
         return 0;
     }
@@ -932,22 +1341,6 @@ static int tokenlen(char *tokens[])
     return length - 1;
 }
 
-/*
- * Function: ctokenlen
- * ----------------------------
- *   Return the number of strings stored inside tokens[]
- *
- *   tokens: const array of strings whose length we want
- *
- *   returns: the number of strings stored inside tokens[]
- */
-static int ctokenlen(const char *tokens[])
-{
-    int length = 0;
-    while (length < NUM_TOKENS && tokens[length++] != NULL)
-        ;
-    return length - 1;
-}
 
 /*
  * Function: getLastOccurence
@@ -984,44 +1377,114 @@ static char *getLastOccurence(char *string, char *substring)
 }
 
 /*
- * Function: getLargestCommonSubstring
+ * Function: findPrefix
  * ----------------------------
- *   Return the largest common substring of all the strings contained in the array strings[]
+ *   Find the terms starting with 'prefix' with two binary searches.
+ *   Since terms are sorted, they are next to each other.
  *
- *   strings:           array of strings with a common substring
- *   initialSubstring:  our initial guess for the largest common substring
+ *   sortedTerms:   array of terms sorted with strcmp
+ *   numberOfTerms: number of terms in sortedTerms
+ *   prefix:        the start of the terms to find
+ *   first:         set to the index of the first term found
  *
- *   returns: The largest common substring of all the strings contained in the array strings[]
+ *   returns: the number of terms found
  */
-static char* getLargestCommonSubstring(const char *strings[], const char *initialSubstring)
+static int findPrefix(const char *sortedTerms[], int numberOfTerms, const char *prefix, int *first)
 {
-    char substring[TOKENSIZE];
-    strcpy(substring, initialSubstring);
-    int numberOfStrings = ctokenlen(strings);
-    int matchingStrings = numberOfStrings;
-    int strLen;
-    int loopRan_flag = 0;
-    while (matchingStrings == numberOfStrings && strlen(strings[0]) > strlen(substring))
+    size_t prefixLength = strlen(prefix);
+
+    //first term that is not smaller than the prefix
+    int low = 0, high = numberOfTerms;
+    while (low < high)
     {
-        loopRan_flag = 1;
-        matchingStrings = 0;
-        strLen = strlen(substring);
-        substring[strLen + 1] = '\0';
-        substring[strLen] = strings[0][strLen];
-        for (size_t current = 0; current < numberOfStrings; current++)
-        {
-            if (strstr(strings[current], substring) == strings[current])
-            {
-                matchingStrings++;
-            }
+        int middle = (low + high) / 2;
+        if (strcmp(sortedTerms[middle], prefix) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
         }
-        
     }
-    if (loopRan_flag)
+    *first = low;
+
+    //first term after it that does not start with the prefix
+    high = numberOfTerms;
+    while (low < high)
     {
-        substring[strlen(substring) - 1] = '\0';
+        int middle = (low + high) / 2;
+        if (!strncmp(sortedTerms[middle], prefix, prefixLength)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low - *first;
+}
+
+/*
+ * Function: commonPrefixLength
+ * ----------------------------
+ *   Return the length of the largest common prefix of two strings
+ *
+ *   a, b: the strings to compare
+ *
+ *   returns: the number of characters a and b have in common from their start
+ */
+static size_t commonPrefixLength(const char *a, const char *b)
+{
+    size_t length = 0;
+    while (a[length] != '\0' && a[length] == b[length]) {
+        length++;
     }
-    return strdup(substring);
+    return length;
+}
+
+/*
+ * Function: displaySetVariable
+ * ----------------------------
+ *   Display the result of the set command.
+ *
+ *   var: name of the variable that was set
+ *   error: whether saving the variable failed
+ *   result: value of the variable read back after saving it. Freed by the call
+ *
+ *   returns: 0 if the variable was saved and read back. 1 otherwise.
+ */
+static int displaySetVariable(char *var, int error, char *result)
+{
+    if (error)
+    {
+        printColor(RED, "Error saving variable: memory is full\n");
+        return 1;
+    }
+    if (!result)
+    {
+        printColor(RED, "Error retrieving variable. Please try saving again\n");
+        return 1;
+    }
+    printf("%s = %s\n", var, result);
+    free(result);
+    return 0;
+}
+
+/*
+ * Function: displayVariable
+ * ----------------------------
+ *   Display the result of the print command.
+ *
+ *   result: value of the variable. NULL if it does not exist. Freed by the call
+ *
+ *   returns: 0 if the variable exists. 1 otherwise.
+ */
+static int displayVariable(char *result)
+{
+    if (!result)
+    {
+        printColor(RED, "Variable does not exist\n");
+        return 1;
+    }
+    printf("%s\n", result);
+    free(result);
+    return 0;
 }
 
 /*
@@ -1,18 +1,36 @@
 #ifndef INTERPRETER_HEADER
     #define INTERPRETER_HEADER
 
+    #include "terminal-io.h"
+
     #define ITEMS_PER_LINE 8
-    #define NUM_FILES 200
+    #define PREFETCH_HISTORY 100    //number of recent commands searched for script directories to prefetch
+    #define AUTOCOMPLETE_MAX_LISTED (ITEMS_PER_LINE * 8)    //autocomplete options printed, best first
+    #define RECENT_HISTORY 100      //number of recent commands whose words are ranked higher by autocomplete
+    #define RECENT_BONUS 64         //score added to an option used by the most recent command
+    #define RECENT_WORDS_SIZE 1024  //slots of the table of recent words, power of 2
     
     /*
     * Function: tabAutocomplete
     * ----------------------------
     *   attempt to autocomplete the user command.
+    *   The autocompleted token is replaced in the terminal line,
+    *   which grows as needed, and the cursor is moved to its end.
     * 
+    *   terminalLine: the user command
     *   tokens: user command in tokenized form
-    *   string: unparsed user command
+    *
+    *   return: 0 if the autocomplete ran without error. 1 otherwise.
     */
-    extern int tabAutocomplete(char* string, char *tokens[], int cursorPosition);
+    extern int tabAutocomplete(TERMINAL_LINE* terminalLine, char *tokens[]);
+
+    /*
+    * Function: autocomplete_prefetch
+    * ----------------------------
+    *   Start reading, on a background thread, the directories file names are most likely
+    *   to be autocompleted in, so the first tab in them does not wait for the file system.
+    */
+    extern void autocomplete_prefetch();
 
 
     /*
@@ -26,4 +44,66 @@
     *            1 otherwise.
     */
     extern int interpreter(char* tokens[]);
+
+    /*
+    * Function: interpreter_set
+    * ----------------------------
+    *   Assign a value to a shell variable and display it. Runs the set command
+    *   once its arguments are validated.
+    *
+    *   var: name of the variable. Must not be empty
+    *   value: value to assign to the variable
+    *
+    *   returns: 0 if successful. 1 otherwise.
+    */
+    extern int interpreter_set(char *var, char *value);
+
+    /*
+    * Function: interpreter_setSlot
+    * ----------------------------
+    *   Behaves exactly like interpreter_set, for the variable stored in 'slot'.
+    *   The name of the variable is not looked up: it is only displayed.
+    *
+    *   slot: slot of the variable, returned by internVar()
+    *   var: name of the variable
+    *   value: value to assign to the variable
+    *
+    *   returns: 0 if successful. 1 otherwise.
+    */
+    extern int interpreter_setSlot(int slot, char *var, char *value);
+
+    /*
+    * Function: interpreter_print
+    * ----------------------------
+    *   Display the value of a shell variable. Runs the print command
+    *   once its arguments are validated.
+    *
+    *   var: name of the variable
+    *
+    *   returns: 0 if successful. 1 if the variable does not exist.
+    */
+    extern int interpreter_print(char *var);
+
+    /*
+    * Function: interpreter_printSlot
+    * ----------------------------
+    *   Behaves exactly like interpreter_print, for the variable stored in 'slot'.
+    *
+    *   slot: slot of the variable, returned by internVar()
+    *
+    *   returns: 0 if successful. 1 if the variable does not exist.
+    */
+    extern int interpreter_printSlot(int slot);
+
+    /*
+    * Function: interpreter_echo
+    * ----------------------------
+    *   Display a string on a new line. Runs the echo command
+    *   once its arguments are validated.
+    *
+    *   string: the string to display
+    *
+    *   returns: 0
+    */
+    extern int interpreter_echo(char *string);
 #endif
@@ -1,57 +1,180 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
 #include "shell.h"
+#include "shellmemory.h"
+#include "terminal-io.h"
 #include "pcb.h"
 #include "ram.h"
 #include "cpu.h"
+#include "readyqueue.h"
+#include "stats.h"
+#include "trace.h"
 #include "kernel.h"
 
+#define BATCH_OUTPUT_BUFFER_SIZE (4 << 20) //stdout is only flushed when this many bytes were written in batch mode
+
 struct pcbQueueNode {
     struct PCB* pcb;
     struct pcbQueueNode* nextNode;
 };
 
-static struct pcbQueueNode* readyQueueTail = NULL;
+//arguments of a background loader thread
+struct loadRequest {
+    char** filenames;
+    int numberOfPrograms;
+};
+
+//every CPU has its own ready queue. Idle CPUs steal processes from the ready queues of other CPUs
+static struct readyQueue readyQueues[MAX_CPUS];
+static int numberOfCPUs = 1;
+static int quanta = QUANTA;                     //number of instructions a process runs before being switched out
+static char* statsFilename = NULL;              //file the scheduler statistics are written to on exit
+static char* traceFilename = NULL;              //file the Chrome trace is written to on exit
+static int batchMode = 0;                       //run the commands of batchFilename (stdin if NULL) without a terminal
+static char* batchFilename = NULL;
+static char* historyFilename = NULL;            //file the command history is read from and saved to
+static int historySize = HISTORY_SIZE;          //number of commands the history can navigate through
+static atomic_int activeProcesses = 0;          //processes that are either in a ready queue or running on a CPU
+static atomic_int pendingPrograms = 0;          //programs that a loader thread has not finished loading yet
+
+/*
+ * Only the CPU that owns a ready queue can add processes to it. Processes loaded by
+ * other threads are added to the new process queue, which CPUs move into their own ready queue.
+ */
+static struct pcbQueueNode* newProcessHead = NULL;
+static struct pcbQueueNode* newProcessTail = NULL;
+static atomic_int numberOfNewProcesses = 0;     //lets CPUs check the new process queue without locking it
+static pthread_mutex_t newProcessLock = PTHREAD_MUTEX_INITIALIZER;
+
+//loader threads wait for processes to terminate when a program does not fit in RAM
+static pthread_mutex_t terminationLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t processTerminated = PTHREAD_COND_INITIALIZER;
+
+//processes indexed by process ID. Used by the jobs and kill commands
+static struct PCB* processTable[MAX_CONCURRENT_PROCS] = {NULL};
+static pthread_mutex_t processTableLock = PTHREAD_MUTEX_INITIALIZER;
+
+//the scheduler can run on a background thread (exec ... &) while the shell keeps reading commands
+static enum {BACKGROUND_NONE, BACKGROUND_RUNNING, BACKGROUND_FINISHED} backgroundState = BACKGROUND_NONE;
+static pthread_t backgroundThread;
+static pthread_mutex_t backgroundLock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread int currentCPU = 0;             //index of the CPU the calling thread acts as
+static __thread int isRunningScheduler = 0;     //whether the calling thread is currently acting as a CPU
 
 static int getNumberOfLines(FILE *file);
+static int loadProgram(char* filename, int waitForRoom);
+static int requestProcId_wait(int size);
 static void addToReady(struct PCB* pcb);
-static void removeNodeFromReady(struct pcbQueueNode* nodeToDelete);
+static struct PCB* takeNewProcess();
+static void* loaderLoop(void* request);
+static void runCPUs();
+static void* backgroundLoop(void* unused);
+static void* cpuLoop(void* cpuIndex);
+static struct PCB* getNextProcess(int cpuIndex);
+static void runProcess(int cpuIndex, struct PCB* pcb);
+static void terminateProcess(struct PCB* pcb);
 static void destroyProcess(struct PCB* pcb);
+static void destroyReadyQueues();
+static int parseArguments(int argc, char* argv[]);
+static void openHistory();
 
 /*
  * Function: sigintHandler
  * ----------------------------
- *   Triggered when user presses Ctrl-C during the getString method.
- *   Exits the program instead of aborting it. Ensures memory is deallocated and all that jazz.
+ *   Triggered when user presses Ctrl-C.
+ *   Restores the terminal settings and ends the program with _exit: the CPU threads may still
+ *   be running processes, so the atexit cleanup would free PCBs, queues and RAM under them.
  *
  *   sig_num: signal that triggered the interrupt (parameter handled by OS)
  */
 static void sigintHandler(int sig_num)
 {
-    putchar('\n');
-    exit(1);
+    restoreTerminalSettings();
+    write(STDOUT_FILENO, "\n", 1);
+    _exit(1);
 }
 
 /*
  * Function: main
  * ----------------------------
  *   Entry point of kernel.
- *   Initializes RAM and starts the shellUI.
+ *   Initializes RAM and the ready queues and starts the shellUI.
+ * 
+ *   Supported arguments:
+ *      -c N, --cpus N ->       run processes on N CPUs (1 by default)
+ *      -q N, --quanta N ->     run N instructions of a process before switching to the next one (QUANTA by default)
+ *      -s FILE, --stats FILE -> write the scheduler statistics to FILE as JSON on exit
+ *      -t FILE, --trace FILE -> write a Chrome trace of the kernel to FILE on exit (kernel compiled with -DTRACING)
+ * 
+ *      -b [FILE], --batch [FILE] -> run the commands of FILE (stdin by default) without using the terminal,
+ *                               then exit. Output is not colored and is written in large blocks
+ *      -H FILE, --history FILE -> read and save the command history in FILE (~/HISTORY_FILENAME by default)
+ *      --history-size N ->     navigate through the last N commands of the history (HISTORY_SIZE by default)
+ * 
+ *   The MYKERNEL_TRACE and MYKERNEL_HISTORY environment variables can be used instead of --trace and --history.
  * 
  *   return: The shell exit code.
  */
-int main(void){
-    //register cleanup methods
-    atexit(emptyReadyQueue);
+int main(int argc, char* argv[]){
+    if (parseArguments(argc, argv)) {
+        return 1;
+    }
+#ifdef TRACING
+    if (traceFilename == NULL) {
+        traceFilename = getenv("MYKERNEL_TRACE");
+    }
+#endif
+    if (traceFilename != NULL && trace_start(traceFilename)) {
+        return 1;
+    }
+
+    terminal_detectColors();
+    FILE* batchInput = stdin;
+    if (batchMode) {
+        if (batchFilename != NULL && (batchInput = fopen(batchFilename, "r")) == NULL) {
+            fprintf(stderr, "Error: could not open %s\n", batchFilename);
+            return 1;
+        }
+        terminal_setBatchMode(1);
+        setvbuf(stdout, NULL, _IOFBF, BATCH_OUTPUT_BUFFER_SIZE);
+    }
+
+    for (int i = 0; i < numberOfCPUs; i++) {
+        readyQueue_init(&readyQueues[i]);
+    }
 
-    printf("%s\n", "Kernel 1.0 loaded!");
+    //register cleanup methods. Ready queues must be emptied before their buffers are freed
+    atexit(stats_clear);
+    atexit(destroyReadyQueues);
+    atexit(emptyReadyQueue);
 
     //ctrl-c is handled by our own code to ensure terminal settings are reset before program ends.
     signal(SIGINT, sigintHandler);
-
     initializeVram();
-    int error = shellUI();
+
+    int error;
+    if (batchMode) {
+        error = shellUI_batch(batchInput);
+    } else {
+        openHistory();
+        printf("%s\n", "Kernel 1.0 loaded!");
+        error = shellUI();
+    }
+
+    //background processes are allowed to finish before the kernel exits
+    scheduler_wait();
+    if (statsFilename != NULL) {
+        stats_writeJSON(statsFilename);
+    }
+    trace_write();
 
     //let ctrl-c be handled by OS again
     signal(SIGINT, SIG_DFL);
@@ -71,13 +194,26 @@ int main(void){
  *   return: 0 if successful. 1 if error occurred.
  */
 int myinit(char* filename) {
+    return loadProgram(filename, 0);
+}
+
+/*
+ * Function: loadProgram
+ * ----------------------------
+ *   Behaves exactly like myinit. If waitForRoom is set and the program does not
+ *   fit in RAM yet, wait for running processes to terminate instead of failing.
+ * 
+ *   filename: name of file to load into RAM
+ *   waitForRoom: whether to wait for RAM to free up
+ * 
+ *   return: 0 if successful. 1 if error occurred.
+ */
+static int loadProgram(char* filename, int waitForRoom) {
     FILE *script;
     script = fopen(filename, "r");
     if (!script)
     {
-        setColor(RED);
-        printf("exec: Script \'%s\' not found\n", filename);
-        setColor(DEFAULT);
+        printColor(RED, "exec: Script \'%s\' not found\n", filename);
         return 1;
     }
 
@@ -85,21 +221,23 @@ int myinit(char* filename) {
     int numLines = getNumberOfLines(script);
     if (!numLines)
     {
-        setColor(RED);
-        printf("exec: Script \'%s\' is empty\n", filename);
-        setColor(DEFAULT);
+        printColor(RED, "exec: Script \'%s\' is empty\n", filename);
+        fclose(script);
         return 1;
     }
 
     //get PCB
-    int pcbId = requestProcId(numLines);
+    int pcbId = waitForRoom ? requestProcId_wait(numLines) : requestProcId(numLines);
     if (pcbId == -1) {
         //could not get process ID
         fclose(script);
         return 1;
     }
 
-    struct PCB* pcb = makePCB(pcbId);
+    struct PCB* pcb = makePCB(pcbId, filename);
+    pthread_mutex_lock(&processTableLock);
+    processTable[pcbId] = pcb;
+    pthread_mutex_unlock(&processTableLock);
 
     /**
      * load program in RAM. will NEVER fail.
@@ -112,102 +250,498 @@ int myinit(char* filename) {
     return 0;
 }
 
+/*
+ * Function: requestProcId_wait
+ * ----------------------------
+ *   Request a process ID and a RAM memory block of the given size.
+ *   While there are not enough process IDs or RAM, wait for a running
+ *   process to terminate and try again.
+ *   Fail if the program can never fit (no process left to wait for, or larger than RAM).
+ * 
+ *   size: the size of the process we want to load into RAM
+ * 
+ *   return: the process ID. -1 if the program could not be loaded.
+ */
+static int requestProcId_wait(int size) {
+    pthread_mutex_lock(&terminationLock);
+    int pcbId = requestProcId_silent(size);
+    while ((pcbId == RAM_TOO_MANY_PROCS || pcbId == RAM_NOT_ENOUGH_RAM) && atomic_load(&activeProcesses) > 0) {
+        pthread_cond_wait(&processTerminated, &terminationLock);
+        pcbId = requestProcId_silent(size);
+    }
+    pthread_mutex_unlock(&terminationLock);
+
+    if (pcbId < 0) {
+        //last attempt. Prints out why the program could not be loaded if it fails again
+        return requestProcId(size);
+    }
+    return pcbId;
+}
+
+/*
+ * Function: loadPrograms
+ * ----------------------------
+ *   Verify that every program exists and is not empty, then start a background
+ *   loader thread that calls myinit() on every program, in order.
+ *   Each program is added to the ready queue as soon as it is loaded, which lets
+ *   the scheduler run the first programs while the others are still being read.
+ * 
+ *   filenames: names of the files to load into RAM
+ *   numberOfPrograms: number of files in filenames
+ * 
+ *   return: 0 if loading started. 1 if a program is missing or empty (nothing is loaded).
+ */
+int loadPrograms(char* filenames[], int numberOfPrograms) {
+    struct stat fileInfo;
+    for (int i = 0; i < numberOfPrograms; i++) {
+        if (stat(filenames[i], &fileInfo) || S_ISDIR(fileInfo.st_mode)) {
+            printColor(RED, "exec: Script \'%s\' not found\n", filenames[i]);
+            printf("could not load program \'%s\'!\n", filenames[i]);
+            return 1;
+        }
+        if (fileInfo.st_size == 0) {
+            printColor(RED, "exec: Script \'%s\' is empty\n", filenames[i]);
+            printf("could not load program \'%s\'!\n", filenames[i]);
+            return 1;
+        }
+    }
+
+    struct loadRequest* request = (struct loadRequest*) malloc(sizeof(struct loadRequest));
+    request->filenames = (char**) malloc(sizeof(char*) * numberOfPrograms);
+    for (int i = 0; i < numberOfPrograms; i++) {
+        request->filenames[i] = strdup(filenames[i]);
+    }
+    request->numberOfPrograms = numberOfPrograms;
+
+    //programs count as pending before the thread starts so the scheduler waits for them
+    atomic_fetch_add(&pendingPrograms, numberOfPrograms);
+    pthread_t loaderThread;
+    pthread_create(&loaderThread, NULL, loaderLoop, request);
+    pthread_detach(loaderThread);
+    return 0;
+}
+
+/*
+ * Function: loaderLoop
+ * ----------------------------
+ *   Background loader thread. Loads every program of the request into RAM.
+ *   A program that does not fit in RAM yet waits for running processes to terminate.
+ *   A program that cannot be loaded is skipped; the others still run.
+ * 
+ *   request: the loadRequest listing the programs to load. Freed by this function.
+ * 
+ *   return: NULL
+ */
+static void* loaderLoop(void* request) {
+    struct loadRequest* loadRequest = (struct loadRequest*) request;
+    for (int i = 0; i < loadRequest->numberOfPrograms; i++) {
+        if (loadProgram(loadRequest->filenames[i], 1)) {
+            printf("could not load program \'%s\'!\n", loadRequest->filenames[i]);
+            terminal_outputWritten();
+        }
+        free(loadRequest->filenames[i]);
+        atomic_fetch_sub(&pendingPrograms, 1);
+    }
+    free(loadRequest->filenames);
+    free(loadRequest);
+    return NULL;
+}
+
 /*
  * Function: scheduler
  * ----------------------------
- *   Handles the task switching of processes inside the ready queue. 
- *   Moves processes to/from the CPU.
- *   Calls run(quanta), which will execute quanta instructions.
+ *   Handles the task switching of processes inside the ready queues. 
+ *   The calling thread acts as CPU 0. One thread is started for every other CPU.
+ *   Every CPU moves processes from its ready queue to/from the CPU and
+ *   calls run(quanta), which will execute quanta instructions.
+ *   A CPU whose ready queue is empty steals processes from the other CPUs.
  * 
- *   If a process ends, it is removed from the ready queue.
- *   The scheduler runs until the ready queue is empty.
+ *   If a process ends, it is destroyed.
+ *   The scheduler runs until no process is left in any ready queue or on any CPU,
+ *   and every program passed to loadPrograms() has been loaded.
+ * 
+ *   If called by a process that is already running on a CPU (exec inside a script),
+ *   return immediately: the CPUs that are running will pick up the new processes.
+ *   If the scheduler is running in the background, wait for it to finish instead.
  */
 int scheduler() {
-    struct PCB* currentProcess;
-    int processSize;
-    int error = 0;
-    while (readyQueueTail != NULL) {
-        currentProcess = readyQueueTail->nextNode->pcb;
-        processSize = requestProcRam_size(currentProcess->ID);
-        moveToCPU(currentProcess);
-        if (currentProcess->PC + QUANTA < processSize) {
-            error = run(QUANTA);
-            removeFromCPU(currentProcess);
-            if (error) {
-                removeNodeFromReady(readyQueueTail->nextNode);
-            } else {
-                readyQueueTail = readyQueueTail->nextNode;
+    if (isRunningScheduler) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&backgroundLock);
+    int backgroundIsRunning = (backgroundState != BACKGROUND_NONE);
+    pthread_mutex_unlock(&backgroundLock);
+    if (backgroundIsRunning) {
+        return scheduler_wait();
+    }
+
+    runCPUs();
+    return 0;
+}
+
+/*
+ * Function: scheduler_background
+ * ----------------------------
+ *   Run the scheduler on a background thread and return immediately.
+ *   If the background scheduler is already running, it picks up the new processes.
+ * 
+ *   return: 0
+ */
+int scheduler_background() {
+    if (isRunningScheduler) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&backgroundLock);
+    if (backgroundState == BACKGROUND_FINISHED) {
+        pthread_join(backgroundThread, NULL);
+        backgroundState = BACKGROUND_NONE;
+    }
+    if (backgroundState == BACKGROUND_NONE) {
+        backgroundState = BACKGROUND_RUNNING;
+        pthread_create(&backgroundThread, NULL, backgroundLoop, NULL);
+    }
+    pthread_mutex_unlock(&backgroundLock);
+    return 0;
+}
+
+/*
+ * Function: scheduler_wait
+ * ----------------------------
+ *   Wait for the background scheduler to run all of its processes.
+ *   Cannot be called by a process running on a CPU.
+ * 
+ *   return: 0 if successful. 1 if called by a process running on a CPU.
+ */
+int scheduler_wait() {
+    if (isRunningScheduler) {
+        printColor(RED, "wait: cannot wait for processes from inside a running process\n");
+        return 1;
+    }
+
+    pthread_mutex_lock(&backgroundLock);
+    int hasThread = (backgroundState != BACKGROUND_NONE);
+    pthread_mutex_unlock(&backgroundLock);
+
+    //only the shell thread joins the background thread. No one else can change the state to NONE
+    if (hasThread) {
+        pthread_join(backgroundThread, NULL);
+        pthread_mutex_lock(&backgroundLock);
+        backgroundState = BACKGROUND_NONE;
+        pthread_mutex_unlock(&backgroundLock);
+    }
+    return 0;
+}
+
+/*
+ * Function: backgroundLoop
+ * ----------------------------
+ *   Body of the background scheduler thread.
+ *   Before finishing, check (while holding backgroundLock) that no program was
+ *   submitted after the CPUs stopped. scheduler_background() either sees the
+ *   thread still running, or sees it finished and starts a new one.
+ * 
+ *   unused: unused
+ * 
+ *   return: NULL
+ */
+static void* backgroundLoop(void* unused) {
+    while (1) {
+        runCPUs();
+        pthread_mutex_lock(&backgroundLock);
+        if (atomic_load(&activeProcesses) == 0 && atomic_load(&pendingPrograms) == 0) {
+            backgroundState = BACKGROUND_FINISHED;
+            pthread_mutex_unlock(&backgroundLock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&backgroundLock);
+    }
+}
+
+/*
+ * Function: runCPUs
+ * ----------------------------
+ *   The calling thread acts as CPU 0. One thread is started for every other CPU.
+ *   Returns once every CPU has stopped.
+ */
+static void runCPUs() {
+    pthread_t cpuThreads[MAX_CPUS];
+    for (int i = 1; i < numberOfCPUs; i++) {
+        pthread_create(&cpuThreads[i], NULL, cpuLoop, (void*) (long) i);
+    }
+    cpuLoop((void*) 0L);
+    for (int i = 1; i < numberOfCPUs; i++) {
+        pthread_join(cpuThreads[i], NULL);
+    }
+}
+
+/*
+ * Function: cpuLoop
+ * ----------------------------
+ *   Task switching loop of a single CPU.
+ *   Runs processes until no process is left in any ready queue or on any CPU
+ *   and no program is waiting to be loaded.
+ * 
+ *   cpuIndex: index of the CPU (and of its ready queue)
+ * 
+ *   return: NULL
+ */
+static void* cpuLoop(void* cpuIndex) {
+    int cpu = (int) (long) cpuIndex;
+    currentCPU = cpu;
+    isRunningScheduler = 1;
+    TRACE_BEGIN("scheduler");
+    while (atomic_load(&activeProcesses) > 0 || atomic_load(&pendingPrograms) > 0) {
+        struct PCB* pcb = getNextProcess(cpu);
+        if (pcb == NULL) {
+            //the remaining processes are running on other CPUs or being loaded. Let them run
+            sched_yield();
+            continue;
+        }
+        runProcess(cpu, pcb);
+    }
+    TRACE_END("scheduler");
+    isRunningScheduler = 0;
+    currentCPU = 0;
+    return NULL;
+}
+
+/*
+ * Function: getNextProcess
+ * ----------------------------
+ *   Move newly loaded processes to the tail of the CPU ready queue, then
+ *   take the process at the head of the CPU ready queue.
+ *   If the ready queue is empty, steal a process from the CPU
+ *   whose ready queue is the longest.
+ * 
+ *   cpuIndex: index of the CPU requesting a process
+ * 
+ *   return: the process to run. NULL if no process is waiting in any ready queue.
+ */
+static struct PCB* getNextProcess(int cpuIndex) {
+    struct PCB* newProcess;
+    while ((newProcess = takeNewProcess()) != NULL) {
+        readyQueue_push(&readyQueues[cpuIndex], newProcess);
+    }
+
+    struct PCB* pcb = readyQueue_steal(&readyQueues[cpuIndex]);
+    while (pcb == NULL) {
+        int victim = -1;
+        long victimSize = 0;
+        for (int i = 0; i < numberOfCPUs; i++) {
+            long size = readyQueue_size(&readyQueues[i]);
+            if (i != cpuIndex && size > victimSize) {
+                victim = i;
+                victimSize = size;
             }
-        } else {
-            error = run(processSize - currentProcess->PC);
-            removeFromCPU(currentProcess);
-            removeNodeFromReady(readyQueueTail->nextNode);
         }
+        if (victim == -1) {
+            return NULL;
+        }
+        pcb = readyQueue_steal(&readyQueues[victim]);
+    }
+    return pcb;
+}
+
+/*
+ * Function: runProcess
+ * ----------------------------
+ *   Move the process to the CPU, run it for one quanta and remove it from the CPU.
+ *   If the process has ended, encountered an error or was killed, it is terminated.
+ *   Otherwise, it is added back to the tail of the CPU ready queue.
+ * 
+ *   cpuIndex: index of the CPU running the process
+ *   pcb: the process to run
+ */
+static void runProcess(int cpuIndex, struct PCB* pcb) {
+    if (atomic_load(&pcb->killed)) {
+        terminateProcess(pcb);
+        return;
+    }
+
+    //telemetry: time spent in the ready queue, moving to/from the CPU and running
+    long long dispatchedAt = stats_now();
+    int previousPC = pcb->PC;
+    pcb->stats.dispatches++;
+    pcb->stats.waitTime += dispatchedAt - pcb->stats.readySince;
+
+    int processSize = requestProcRam_size(pcb->ID);
+    int instructionsToRun = (pcb->PC + quanta < processSize) ? quanta : processSize - pcb->PC;
+    atomic_store(&pcb->state, PROCESS_RUNNING);
+    moveToCPU(pcb);
+    long long runStartedAt = stats_now();
+    int error = run(instructionsToRun);
+    long long runEndedAt = stats_now();
+    removeFromCPU(pcb);
+    atomic_store(&pcb->state, PROCESS_READY);
+    long long removedAt = stats_now();
+
+    pcb->stats.instructions += pcb->PC - previousPC;
+    pcb->stats.runTime += runEndedAt - runStartedAt;
+    pcb->stats.switchTime += (runStartedAt - dispatchedAt) + (removedAt - runEndedAt);
+    pcb->stats.readySince = removedAt;
+
+    if (error || pcb->PC >= processSize || atomic_load(&pcb->killed)) {
+        terminateProcess(pcb);
+    } else {
+        readyQueue_push(&readyQueues[cpuIndex], pcb);
     }
-    return 0;
 }
 
 /*
  * Function: addToReady
  * ----------------------------
- *   Add a PCB to the tail of the ready queue
+ *   Add a PCB to the tail of a ready queue.
+ *   Processes loaded by a CPU are added to the ready queue of that CPU.
+ *   Processes loaded by any other thread are added to the new process queue.
  * 
  *   pcb: process to add to the ready queue
  */
 static void addToReady(struct PCB* pcb) {
+    atomic_fetch_add(&activeProcesses, 1);
+    if (isRunningScheduler) {
+        readyQueue_push(&readyQueues[currentCPU], pcb);
+        return;
+    }
+
     struct pcbQueueNode* newNode = (struct pcbQueueNode*) malloc(sizeof(struct pcbQueueNode));
-    if (readyQueueTail == NULL) {
-        readyQueueTail = newNode;
-        newNode->pcb = pcb;
-        newNode->nextNode = newNode;
+    newNode->pcb = pcb;
+    newNode->nextNode = NULL;
+    pthread_mutex_lock(&newProcessLock);
+    if (newProcessTail == NULL) {
+        newProcessHead = newNode;
     } else {
-        newNode->pcb = pcb;
-        newNode->nextNode = readyQueueTail->nextNode;
-        readyQueueTail->nextNode = newNode;
-        readyQueueTail = newNode;
+        newProcessTail->nextNode = newNode;
     }
-    return;
+    newProcessTail = newNode;
+    atomic_fetch_add(&numberOfNewProcesses, 1);
+    pthread_mutex_unlock(&newProcessLock);
 }
 
 /*
- * Function: removeNodeFromReady
+ * Function: takeNewProcess
  * ----------------------------
- *   Removes the specified node from the ready queue.
- *   This leads to the PCB associated with the node being destroyed.
+ *   Remove the PCB at the head of the new process queue.
  * 
- *   nodeToDelete: the node we wish to remove from the queue.
+ *   return: the removed PCB. NULL if the new process queue is empty.
  */
-static void removeNodeFromReady(struct pcbQueueNode* nodeToDelete) {
-    if (readyQueueTail == NULL || nodeToDelete == NULL ) {
-        return;
+static struct PCB* takeNewProcess() {
+    if (atomic_load(&numberOfNewProcesses) == 0) {
+        return NULL;
     }
-    if (nodeToDelete->nextNode == nodeToDelete) {   //only happens when queue has 1 element
-        destroyProcess(nodeToDelete->pcb);
-        free(nodeToDelete);
-        readyQueueTail = NULL;
-    } else {
-        struct pcbQueueNode* tmpTail = readyQueueTail;
-        while(tmpTail->nextNode != nodeToDelete) {
-            tmpTail = tmpTail->nextNode;
-        }
-        tmpTail->nextNode = nodeToDelete->nextNode;
-        destroyProcess(nodeToDelete->pcb);
-        if (readyQueueTail == nodeToDelete) {
-            readyQueueTail = tmpTail;
+    pthread_mutex_lock(&newProcessLock);
+    struct pcbQueueNode* node = newProcessHead;
+    if (node != NULL) {
+        newProcessHead = node->nextNode;
+        if (newProcessHead == NULL) {
+            newProcessTail = NULL;
         }
-        free(nodeToDelete);
+        atomic_fetch_sub(&numberOfNewProcesses, 1);
+    }
+    pthread_mutex_unlock(&newProcessLock);
+
+    if (node == NULL) {
+        return NULL;
     }
+    struct PCB* pcb = node->pcb;
+    free(node);
+    return pcb;
+}
+
+/*
+ * Function: terminateProcess
+ * ----------------------------
+ *   Destroy a process that is no longer in any ready queue.
+ * 
+ *   pcb: the process to terminate
+ */
+static void terminateProcess(struct PCB* pcb) {
+    pcb->stats.turnaroundTime = stats_now() - pcb->stats.loadedAt;
+    stats_record(pcb->ID, pcb->name, &pcb->stats);
+
+    pthread_mutex_lock(&processTableLock);
+    processTable[pcb->ID] = NULL;
+    pthread_mutex_unlock(&processTableLock);
+
+    destroyProcess(pcb);
+    atomic_fetch_sub(&activeProcesses, 1);
+
+    //let waiting loader threads know that RAM was freed
+    pthread_mutex_lock(&terminationLock);
+    pthread_cond_broadcast(&processTerminated);
+    pthread_mutex_unlock(&terminationLock);
 }
 
 /*
  * Function: emptyReadyQueue
  * ----------------------------
- *   Remove all nodes from the ReadyQueue.
- *   Calls removeNodeFromReady()
+ *   Remove all processes from the ready queues and terminate them.
  */
 void emptyReadyQueue() {
-    while (readyQueueTail != NULL) {
-        removeNodeFromReady(readyQueueTail);
+    struct PCB* newProcess;
+    while ((newProcess = takeNewProcess()) != NULL) {
+        terminateProcess(newProcess);
+    }
+    for (int i = 0; i < numberOfCPUs; i++) {
+        struct PCB* pcb;
+        while ((pcb = readyQueue_steal(&readyQueues[i])) != NULL) {
+            terminateProcess(pcb);
+        }
+    }
+}
+
+/*
+ * Function: killProcess
+ * ----------------------------
+ *   Flag a process to be terminated. A process that is running finishes its
+ *   current quanta first.
+ * 
+ *   pid: ID of the process to kill
+ * 
+ *   return: 0 if successful. 1 if no process has that ID.
+ */
+int killProcess(int pid) {
+    int error = 1;
+    pthread_mutex_lock(&processTableLock);
+    if (pid >= 0 && pid < MAX_CONCURRENT_PROCS && processTable[pid] != NULL) {
+        atomic_store(&processTable[pid]->killed, 1);
+        error = 0;
+    }
+    pthread_mutex_unlock(&processTableLock);
+
+    if (error) {
+        printColor(RED, "kill: no process with ID %d\n", pid);
+    }
+    return error;
+}
+
+/*
+ * Function: printJobs
+ * ----------------------------
+ *   Print the ID, state and script name of every process that was loaded
+ *   and has not terminated yet.
+ */
+void printJobs() {
+    pthread_mutex_lock(&processTableLock);
+    for (int pid = 0; pid < MAX_CONCURRENT_PROCS; pid++) {
+        struct PCB* pcb = processTable[pid];
+        if (pcb != NULL) {
+            const char* state = atomic_load(&pcb->state) == PROCESS_RUNNING ? "running" : "ready";
+            printf("[%d]  %-8s %s%s\n", pid, state, pcb->name, atomic_load(&pcb->killed) ? " (killed)" : "");
+        }
+    }
+    pthread_mutex_unlock(&processTableLock);
+}
+
+/*
+ * Function: destroyReadyQueues
+ * ----------------------------
+ *   Free the memory used by the ready queues of all CPUs.
+ */
+static void destroyReadyQueues() {
+    for (int i = 0; i < numberOfCPUs; i++) {
+        readyQueue_destroy(&readyQueues[i]);
     }
 }
 
@@ -248,4 +782,79 @@ static int getNumberOfLines(FILE *file) {
     }
     fseek(file, 0, SEEK_SET);
     return numberOfLines;
+}
+
+/*
+ * Function: parseArguments
+ * ----------------------------
+ *   Parse the kernel command line arguments.
+ * 
+ *   argc: number of arguments
+ *   argv: the arguments
+ * 
+ *   return: 0 if successful. 1 if an argument is invalid.
+ */
+static int parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if ((!strcmp(argv[i], "-c") || !strcmp(argv[i], "--cpus")) && i + 1 < argc) {
+            numberOfCPUs = atoi(argv[++i]);
+            if (numberOfCPUs < 1 || numberOfCPUs > MAX_CPUS) {
+                fprintf(stderr, "Error: number of CPUs must be between 1 and %d\n", MAX_CPUS);
+                return 1;
+            }
+        } else if ((!strcmp(argv[i], "-q") || !strcmp(argv[i], "--quanta")) && i + 1 < argc) {
+            quanta = atoi(argv[++i]);
+            if (quanta < 1) {
+                fprintf(stderr, "Error: quanta must be at least 1\n");
+                return 1;
+            }
+        } else if ((!strcmp(argv[i], "-s") || !strcmp(argv[i], "--stats")) && i + 1 < argc) {
+            statsFilename = argv[++i];
+        } else if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--trace")) && i + 1 < argc) {
+            traceFilename = argv[++i];
+        } else if ((!strcmp(argv[i], "-H") || !strcmp(argv[i], "--history")) && i + 1 < argc) {
+            historyFilename = argv[++i];
+        } else if (!strcmp(argv[i], "--history-size") && i + 1 < argc) {
+            historySize = atoi(argv[++i]);
+            if (historySize < 1) {
+                fprintf(stderr, "Error: history size must be at least 1\n");
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-b") || !strcmp(argv[i], "--batch")) {
+            batchMode = 1;
+            //the input file is optional
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                batchFilename = argv[++i];
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [-c|--cpus NUMBER_OF_CPUS] [-q|--quanta QUANTA] [-s|--stats FILE] [-t|--trace FILE] [-b|--batch [FILE]] [-H|--history FILE] [--history-size N]\n", argv[0]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Function: openHistory
+ * ----------------------------
+ *   Open the command history file given by --history, the MYKERNEL_HISTORY environment
+ *   variable or HISTORY_FILENAME in the home directory, in this order.
+ *   The history is not saved if none of them can be opened.
+ */
+static void openHistory() {
+    char* filename = historyFilename;
+    char* defaultFilename = NULL;
+    if (filename == NULL) {
+        filename = getenv("MYKERNEL_HISTORY");
+    }
+    const char* home = getenv("HOME");
+    if (filename == NULL && home != NULL) {
+        defaultFilename = (char*) malloc(strlen(home) + strlen(HISTORY_FILENAME) + 2);
+        sprintf(defaultFilename, "%s/%s", home, HISTORY_FILENAME);
+        filename = defaultFilename;
+    }
+    if (history_open(filename, historySize) && filename != NULL) {
+        fprintf(stderr, "Warning: could not open %s, the command history will not be saved\n", filename);
+    }
+    free(defaultFilename);
 }
\ No newline at end of file
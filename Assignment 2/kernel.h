@@ -15,6 +15,21 @@
     */
     extern int myinit(char* filename);
 
+    /*
+    * Function: loadPrograms
+    * ----------------------------
+    *   Verify that every program exists and is not empty, then start a background
+    *   loader thread that calls myinit() on every program, in order.
+    *   Each program is added to the ready queue as soon as it is loaded, which lets
+    *   the scheduler run the first programs while the others are still being read.
+    * 
+    *   filenames: names of the files to load into RAM
+    *   numberOfPrograms: number of files in filenames
+    * 
+    *   return: 0 if loading started. 1 if a program is missing or empty (nothing is loaded).
+    */
+    extern int loadPrograms(char* filenames[], int numberOfPrograms);
+
     /*
     * Function: scheduler
     * ----------------------------
@@ -22,10 +37,52 @@
     *   Moves processes to/from the CPU.
     * 
     *   If a process ends, it is removed from the ready queue.
-    *   The scheduler runs until the ready queue is empty.
+    *   The scheduler runs until the ready queue is empty and
+    *   every program passed to loadPrograms() has been loaded.
+    *   If the scheduler is running in the background, wait for it to finish instead.
     */
     extern int scheduler();
 
+    /*
+    * Function: scheduler_background
+    * ----------------------------
+    *   Run the scheduler on a background thread and return immediately.
+    *   If the background scheduler is already running, it picks up the new processes.
+    * 
+    *   return: 0
+    */
+    extern int scheduler_background();
+
+    /*
+    * Function: scheduler_wait
+    * ----------------------------
+    *   Wait for the background scheduler to run all of its processes.
+    *   Cannot be called by a process running on a CPU.
+    * 
+    *   return: 0 if successful. 1 if called by a process running on a CPU.
+    */
+    extern int scheduler_wait();
+
+    /*
+    * Function: killProcess
+    * ----------------------------
+    *   Flag a process to be terminated. A process that is running finishes its
+    *   current quanta first.
+    * 
+    *   pid: ID of the process to kill
+    * 
+    *   return: 0 if successful. 1 if no process has that ID.
+    */
+    extern int killProcess(int pid);
+
+    /*
+    * Function: printJobs
+    * ----------------------------
+    *   Print the ID, state and script name of every process that was loaded
+    *   and has not terminated yet.
+    */
+    extern void printJobs();
+
     /*
     * Function: emptyReadyQueue
     * ----------------------------
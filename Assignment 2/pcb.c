@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pcb.h"
 
 /*
@@ -8,13 +9,20 @@
  *   Create a PCB and return a pointer to it.
  *
  *   Id: The id to assign to the new PCB
+ *   name: The name of the script run by the process. A copy is stored in the PCB
  * 
  *   return: A pointer to the newly created PCB
  */
-struct PCB* makePCB(int Id) {
+struct PCB* makePCB(int Id, char* name) {
     struct PCB* pcb = (struct PCB*) malloc(sizeof(struct PCB));
     pcb->ID = Id;
     pcb->PC = 0;
+    pcb->name = strdup(name);
+    atomic_init(&pcb->state, PROCESS_READY);
+    atomic_init(&pcb->killed, 0);
+    memset(&pcb->stats, 0, sizeof(struct processStats));
+    pcb->stats.loadedAt = stats_now();
+    pcb->stats.readySince = pcb->stats.loadedAt;
     return pcb;
 }
 
@@ -26,5 +34,6 @@ struct PCB* makePCB(int Id) {
  *   pcb: the pcb we want to destroy
  */
 void destroyPCB(struct PCB* pcb) {
+    free(pcb->name);
     free(pcb);
 }
\ No newline at end of file
@@ -1,9 +1,20 @@
 #ifndef PCB_HEADER
     #define PCB_HEADER
-    
+    #include <stdatomic.h>
+    #include "stats.h"
+
+    /* states a process goes through once it is loaded */
+    enum PROCESS_STATES {
+        PROCESS_READY, PROCESS_RUNNING
+    };
+
     struct PCB {
         int ID;
         int PC;
+        char* name;         //name of the script the process runs
+        atomic_int state;   //PROCESS_READY or PROCESS_RUNNING. Read by the jobs command
+        atomic_int killed;  //set by the kill command. The process is terminated before its next quanta
+        struct processStats stats;
     };
 
     /*
@@ -12,10 +23,11 @@
     *   Create a PCB and return a pointer to it.
     *
     *   Id: The id to assign to the new PCB
+    *   name: The name of the script run by the process. A copy is stored in the PCB
     * 
     *   return: A pointer to the newly created PCB
     */
-    extern struct PCB* makePCB(int Id);
+    extern struct PCB* makePCB(int Id, char* name);
 
     /*
     * Function: destroyPCB
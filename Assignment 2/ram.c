@@ -1,11 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "terminal-io.h"
 #include "ram.h"
 
 #define RAM_SIZE 1000
-#define MAX_CONCURRENT_PROCS 5 //number of processes allowed to run at the same time
 
 struct ramDataBlock {
     unsigned int start;
@@ -28,8 +28,12 @@ static void consolidateRAM();
 static struct ramDataBlock* blockPtr;
 static struct vMemMngr processList[MAX_CONCURRENT_PROCS]; 
 static char* ram[RAM_SIZE] = {NULL};
+static struct instruction instructions[RAM_SIZE];  //RAM lines compiled when they are loaded
 static unsigned int unallocatedRAM = RAM_SIZE;
 
+//processes are created and destroyed by multiple CPUs. Only one of them can modify the RAM datablocks at a time.
+static pthread_mutex_t ramLock = PTHREAD_MUTEX_INITIALIZER;
+
 
 /*
  * Function: initializeVram
@@ -71,6 +75,7 @@ void ram_clear() {
             free(ram[i]);
             ram[i] = NULL;
         }
+        bytecode_free(&instructions[i]);
     }
 }
 
@@ -120,6 +125,19 @@ char* readRamLocation(int location) {
     return ram[location];
 }
 
+/*
+ * Function: readRamInstruction
+ * ----------------------------
+ *   Return the compiled instruction stored at RAM location specified
+ * 
+ *   location: index in RAM
+ * 
+ *   return: the instruction stored at RAM location
+ */
+const struct instruction* readRamInstruction(int location) {
+    return &instructions[location];
+}
+
 /*
  * Function: requestProcId
  * ----------------------------
@@ -133,15 +151,42 @@ char* readRamLocation(int location) {
  *   return: process ID that is associated with the allocated RAM datablock
  */
 int requestProcId(int size) {
+    int id = requestProcId_silent(size);
+    if (id == RAM_TOO_MANY_PROCS) {
+        printColor(RED, "Error: Cannot add program. Too many programs running concurrently!\n");
+        return -1;
+    }
+    if (id == RAM_NOT_ENOUGH_RAM || id == RAM_TOO_LARGE) {
+        printColor(RED, "Error: Not enough RAM to add program!\n");
+        return -1;
+    }
+    return id;
+}
+
+/*
+ * Function: requestProcId_silent
+ * ----------------------------
+ *   Behaves exactly like requestProcId, except that no error is printed
+ *   and the reason of a failure is returned instead.
+ * 
+ *   size: the size of the process we want to load into RAM
+ * 
+ *   return: process ID that is associated with the allocated RAM datablock.
+ *           RAM_TOO_MANY_PROCS, RAM_NOT_ENOUGH_RAM or RAM_TOO_LARGE otherwise.
+ */
+int requestProcId_silent(int size) {
+    if (size > RAM_SIZE) {
+        return RAM_TOO_LARGE;
+    }
+
+    pthread_mutex_lock(&ramLock);
     int id = 0;
     while (id < MAX_CONCURRENT_PROCS && processList[id].ramBlock != NULL) {
         id++;
     }
     if (id == MAX_CONCURRENT_PROCS) {
-        setColor(RED);
-        printf("Error: Cannot add program. Too many programs running concurrently!\n");
-        setColor(DEFAULT);
-        return -1;
+        pthread_mutex_unlock(&ramLock);
+        return RAM_TOO_MANY_PROCS;
     }
 
     //allocate a ram datablock for process to use
@@ -155,16 +200,13 @@ int requestProcId(int size) {
 
         //if we couldn't allocate ram datablock
         if (memoryLocation == NULL) {
-            setColor(RED);
-            printf("Error: Not enough RAM to add program!\n");
-            setColor(DEFAULT);
-            return -1;
+            pthread_mutex_unlock(&ramLock);
+            return RAM_NOT_ENOUGH_RAM;
         }
     }
-    else {
-        processList[id].ramBlock = memoryLocation;
-    }
+    processList[id].ramBlock = memoryLocation;
 
+    pthread_mutex_unlock(&ramLock);
     return id;
 }
 
@@ -255,15 +297,18 @@ static struct ramDataBlock* allocateRamDataBlock(int size) {
  *   ID: the process ID we want to free
  */
 int freeProcId(int ID) {
+    pthread_mutex_lock(&ramLock);
     deallocateRamDataBlock(processList[ID].ramBlock);
     consolidateRAM();
     processList[ID].ramBlock = NULL;
+    pthread_mutex_unlock(&ramLock);
 }
 
 /*
  * Function: addToRAM
  * ----------------------------
  *   Load file data into a RAM datablock associated with the specified process
+ *   and compile every line into an instruction.
  * 
  *   p: the file to read
  *   vRamId: the processId associated with the RAM datablock we are filling
@@ -292,6 +337,8 @@ void addToRAM(FILE* p, int vRamId) {
             }
             ram[processList[vRamId].ramBlock->start + i] = strdup(temp);
         }
+        bytecode_free(&instructions[processList[vRamId].ramBlock->start + i]);
+        bytecode_compile(ram[processList[vRamId].ramBlock->start + i], &instructions[processList[vRamId].ramBlock->start + i]);
     }
 }
 
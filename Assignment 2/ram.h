@@ -1,5 +1,8 @@
 #ifndef RAM_HEADER
     #define RAM_HEADER
+    #include "bytecode.h"
+
+    #define MAX_CONCURRENT_PROCS 5 //number of processes allowed to run at the same time
 
     /*
     * Function: requestProcId
@@ -15,6 +18,24 @@
     */
     extern int requestProcId(int size);
 
+    //error codes returned by requestProcId_silent
+    #define RAM_TOO_MANY_PROCS -1   //all process IDs are in use
+    #define RAM_NOT_ENOUGH_RAM -2   //no free RAM datablock is large enough right now
+    #define RAM_TOO_LARGE -3        //the process is larger than RAM and can never be loaded
+
+    /*
+    * Function: requestProcId_silent
+    * ----------------------------
+    *   Behaves exactly like requestProcId, except that no error is printed
+    *   and the reason of a failure is returned instead.
+    * 
+    *   size: the size of the process we want to load into RAM
+    * 
+    *   return: process ID that is associated with the allocated RAM datablock.
+    *           RAM_TOO_MANY_PROCS, RAM_NOT_ENOUGH_RAM or RAM_TOO_LARGE otherwise.
+    */
+    extern int requestProcId_silent(int size);
+
     /*
     * Function: freeProcId
     * ----------------------------
@@ -63,11 +84,23 @@
     *   return: the data stored at RAM location
     */
     extern char* readRamLocation(int location);
+
+    /*
+    * Function: readRamInstruction
+    * ----------------------------
+    *   Return the compiled instruction stored at RAM location specified
+    * 
+    *   location: index in RAM
+    * 
+    *   return: the instruction stored at RAM location
+    */
+    extern const struct instruction* readRamInstruction(int location);
         
     /*
     * Function: addToRAM
     * ----------------------------
     *   Load file data into a RAM datablock associated with the specified process
+    *   and compile every line into an instruction.
     * 
     *   p: the file to read
     *   vRamId: the processId associated with the RAM datablock we are filling
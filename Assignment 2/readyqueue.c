@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "pcb.h"
+#include "readyqueue.h"
+
+#define READYQUEUE_INITIAL_SIZE 16
+
+static struct readyQueueBuffer* createBuffer(long size, struct readyQueueBuffer* previousBuffer);
+static struct readyQueueBuffer* growBuffer(struct readyQueue* queue, long top, long bottom);
+
+/*
+ * Function: readyQueue_init
+ * ----------------------------
+ *   Initialize an empty ready queue.
+ *
+ *   queue: the ready queue to initialize
+ */
+void readyQueue_init(struct readyQueue* queue) {
+    atomic_init(&queue->top, 0);
+    atomic_init(&queue->bottom, 0);
+    atomic_init(&queue->buffer, createBuffer(READYQUEUE_INITIAL_SIZE, NULL));
+}
+
+/*
+ * Function: readyQueue_destroy
+ * ----------------------------
+ *   Free all the buffers used by the ready queue.
+ *   PCBs still stored in the queue are NOT destroyed.
+ *
+ *   queue: the ready queue to destroy
+ */
+void readyQueue_destroy(struct readyQueue* queue) {
+    struct readyQueueBuffer* buffer = atomic_load(&queue->buffer);
+    while (buffer != NULL) {
+        struct readyQueueBuffer* previousBuffer = buffer->previousBuffer;
+        free(buffer);
+        buffer = previousBuffer;
+    }
+    atomic_store(&queue->buffer, NULL);
+}
+
+/*
+ * Function: readyQueue_push
+ * ----------------------------
+ *   Add a PCB to the bottom of the ready queue.
+ *   Must only be called by the CPU that owns the queue.
+ *
+ *   queue: the ready queue to add the PCB to
+ *   pcb: the PCB to add
+ */
+void readyQueue_push(struct readyQueue* queue, struct PCB* pcb) {
+    long bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    struct readyQueueBuffer* buffer = atomic_load_explicit(&queue->buffer, memory_order_relaxed);
+
+    if (bottom - top > buffer->size - 1) {
+        buffer = growBuffer(queue, top, bottom);
+    }
+    atomic_store_explicit(&buffer->slots[bottom % buffer->size], pcb, memory_order_relaxed);
+
+    //the PCB must be visible to other CPUs before they can see the new bottom.
+    //A release store rather than a fence followed by a relaxed store: the thread sanitizer does not model fences
+    atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_release);
+}
+
+/*
+ * Function: readyQueue_steal
+ * ----------------------------
+ *   Remove the PCB located at the top of the ready queue.
+ *   Can be called by any CPU.
+ *
+ *   queue: the ready queue to take the PCB from
+ *
+ *   return: the PCB that was removed. NULL if the queue is empty.
+ */
+struct PCB* readyQueue_steal(struct readyQueue* queue) {
+    while (1) {
+        long top = atomic_load_explicit(&queue->top, memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        long bottom = atomic_load_explicit(&queue->bottom, memory_order_acquire);
+        if (top >= bottom) {
+            return NULL;
+        }
+
+        struct readyQueueBuffer* buffer = atomic_load_explicit(&queue->buffer, memory_order_acquire);
+        struct PCB* pcb = atomic_load_explicit(&buffer->slots[top % buffer->size], memory_order_relaxed);
+
+        if (atomic_compare_exchange_strong_explicit(&queue->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            return pcb;
+        }
+        //another CPU took the PCB before we did. Try again with the new top
+    }
+}
+
+/*
+ * Function: readyQueue_size
+ * ----------------------------
+ *   Return an estimate of the number of PCBs in the ready queue.
+ *   The value can be outdated as soon as it is returned.
+ *
+ *   queue: the ready queue to measure
+ *
+ *   return: the number of PCBs in the ready queue
+ */
+long readyQueue_size(struct readyQueue* queue) {
+    long top = atomic_load_explicit(&queue->top, memory_order_relaxed);
+    long bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    return bottom > top ? bottom - top : 0;
+}
+
+/*
+ * Function: createBuffer
+ * ----------------------------
+ *   Create a buffer able to hold size PCBs.
+ *
+ *   size: the number of PCBs the buffer can hold
+ *   previousBuffer: the buffer being replaced. NULL if there is none.
+ *
+ *   return: a pointer to the newly created buffer
+ */
+static struct readyQueueBuffer* createBuffer(long size, struct readyQueueBuffer* previousBuffer) {
+    struct readyQueueBuffer* buffer = (struct readyQueueBuffer*) malloc(sizeof(struct readyQueueBuffer) + sizeof(struct PCB*) * size);
+    buffer->size = size;
+    buffer->previousBuffer = previousBuffer;
+    for (long i = 0; i < size; i++) {
+        atomic_init(&buffer->slots[i], NULL);
+    }
+    return buffer;
+}
+
+/*
+ * Function: growBuffer
+ * ----------------------------
+ *   Replace the queue buffer with one twice as large and copy over
+ *   the PCBs located between top and bottom.
+ *
+ *   queue: the queue whose buffer is full
+ *   top: the current top of the queue
+ *   bottom: the current bottom of the queue
+ *
+ *   return: the new buffer
+ */
+static struct readyQueueBuffer* growBuffer(struct readyQueue* queue, long top, long bottom) {
+    struct readyQueueBuffer* oldBuffer = atomic_load_explicit(&queue->buffer, memory_order_relaxed);
+    struct readyQueueBuffer* newBuffer = createBuffer(oldBuffer->size * 2, oldBuffer);
+    for (long i = top; i < bottom; i++) {
+        struct PCB* pcb = atomic_load_explicit(&oldBuffer->slots[i % oldBuffer->size], memory_order_relaxed);
+        atomic_store_explicit(&newBuffer->slots[i % newBuffer->size], pcb, memory_order_relaxed);
+    }
+    atomic_store_explicit(&queue->buffer, newBuffer, memory_order_release);
+    return newBuffer;
+}
@@ -0,0 +1,80 @@
+#ifndef READYQUEUE_HEADER
+    #define READYQUEUE_HEADER
+    #include <stdatomic.h>
+    #include "pcb.h"
+
+    /*
+     * Each CPU owns one ready queue. A ready queue is a Chase-Lev work-stealing deque:
+     * only the owning CPU pushes PCBs at the bottom, while any CPU (the owner included)
+     * takes PCBs from the top. Taking from the top keeps the queue first-in first-out,
+     * which preserves the round robin order of the processes on each CPU.
+     *
+     * The queue grows when full. Replaced buffers are kept until the queue is destroyed
+     * since a CPU that is stealing might still be reading from them.
+    */
+    struct readyQueueBuffer {
+        long size;
+        struct readyQueueBuffer* previousBuffer;
+        _Atomic(struct PCB*) slots[];
+    };
+
+    struct readyQueue {
+        atomic_long top;
+        atomic_long bottom;
+        _Atomic(struct readyQueueBuffer*) buffer;
+    };
+
+    /*
+    * Function: readyQueue_init
+    * ----------------------------
+    *   Initialize an empty ready queue.
+    *
+    *   queue: the ready queue to initialize
+    */
+    extern void readyQueue_init(struct readyQueue* queue);
+
+    /*
+    * Function: readyQueue_destroy
+    * ----------------------------
+    *   Free all the buffers used by the ready queue.
+    *   PCBs still stored in the queue are NOT destroyed.
+    *
+    *   queue: the ready queue to destroy
+    */
+    extern void readyQueue_destroy(struct readyQueue* queue);
+
+    /*
+    * Function: readyQueue_push
+    * ----------------------------
+    *   Add a PCB to the bottom of the ready queue.
+    *   Must only be called by the CPU that owns the queue.
+    *
+    *   queue: the ready queue to add the PCB to
+    *   pcb: the PCB to add
+    */
+    extern void readyQueue_push(struct readyQueue* queue, struct PCB* pcb);
+
+    /*
+    * Function: readyQueue_steal
+    * ----------------------------
+    *   Remove the PCB located at the top of the ready queue.
+    *   Can be called by any CPU.
+    *
+    *   queue: the ready queue to take the PCB from
+    *
+    *   return: the PCB that was removed. NULL if the queue is empty.
+    */
+    extern struct PCB* readyQueue_steal(struct readyQueue* queue);
+
+    /*
+    * Function: readyQueue_size
+    * ----------------------------
+    *   Return an estimate of the number of PCBs in the ready queue.
+    *   The value can be outdated as soon as it is returned.
+    *
+    *   queue: the ready queue to measure
+    *
+    *   return: the number of PCBs in the ready queue
+    */
+    extern long readyQueue_size(struct readyQueue* queue);
+#endif
@@ -7,11 +7,13 @@
 #include <signal.h>
 #include "interpreter.h"
 #include "shellmemory.h"
+#include "dircache.h"
 #include "terminal-io.h"
 #include "shell.h"
+#include "trace.h"
 
 static int getNumberOfOccurences(char c, char *string); //user input validation
-static int character_isPrintable(char c); //ensure only desired characters are printed on screen
+static int character_isPrintable(int c); //ensure only desired characters are printed on screen
 
 static struct termios oldt, newt;
 static volatile int terminalSettings_set = 0;
@@ -56,13 +58,14 @@ void restoreTerminalSettings() {
  * Function: shell_cleanup
  * ----------------------------
  *   This method is called once the program exits. 
- *   It is used to free all the memory used by the shell memory, shell history,
+ *   It is used to free all the memory used by the shell memory, shell history, directory listings
  *   and restores the terminal settings to ensure running our program does not cause side effects.
  */
 static void shell_cleanup() {
     restoreTerminalSettings();
     memory_clear();
     history_clear();
+    dirCache_clear();
 }
 
 /*
@@ -83,6 +86,8 @@ int shellUI(void)
     //register cleanup methods
     atexit(shell_cleanup);
 
+    //read the directories tab is likely to complete in while the user types
+    autocomplete_prefetch();
 
     //intro message
     printf("%s%s", "Welcome to the shell!\n",
@@ -91,10 +96,7 @@ int shellUI(void)
     //declare variables
     char *tokens[NUM_TOKENS] = {NULL};
     TERMINAL_LINE terminalLine;
-    terminalLine.string = (char *)malloc(sizeof(char) * LINESIZE);
-    strcpy(terminalLine.string, "");
-    terminalLine.cursorPosition = 0;
-    terminalLine.inputStream = stdin;
+    terminalLine_init(&terminalLine, stdin);
 
     int getString_flag = 0;
     char *prompt;
@@ -111,12 +113,14 @@ int shellUI(void)
     while (1)
     {
         //get user input
-        printf("\r%s", getString_flag ? terminalLine.string : "");
-        getString_flag = getLine(&terminalLine, LINESIZE, echoSTDIN);
+        getString_flag = getLine(&terminalLine, echoSTDIN);
 
         //if reached the end of the input stream (for when input is redirected), reopen stdin to get user input instead
         if (getString_flag == -1) {
-            freopen("/dev/tty", "r", stdin);
+            //no terminal to read from (for example when run by a script): stop the shell
+            if (freopen("/dev/tty", "r", stdin) == NULL) {
+                break;
+            }
             echoSTDIN = 1;
             continue;
         }
@@ -124,13 +128,16 @@ int shellUI(void)
         //process user input
         if (getString_flag) //attempt to tab autocomplete
         {
-            parse(terminalLine.string, ' ', tokens);
-            int moveCursorBy = tabAutocomplete(terminalLine.string, tokens, terminalLine.cursorPosition);
-            terminalLine.cursorPosition += moveCursorBy;
+            //tabAutocomplete edits the terminal line in place
+            parse(terminalLine_getString(&terminalLine), ' ', tokens);
+            tabAutocomplete(&terminalLine, tokens);
         }
         else    //attempt to parse and interpret user input
         {
-            if (!parse(terminalLine.string, ' ', tokens))
+            TRACE_BEGIN("parse");
+            int parseError = parse(terminalLine_getString(&terminalLine), ' ', tokens);
+            TRACE_END("parse");
+            if (!parseError)
             {
                 if (interpreter(tokens) == -1)
                 {
@@ -138,8 +145,7 @@ int shellUI(void)
                 }
             }
             //reset user input to clear terminal line
-            terminalLine.string[0] = '\0';
-            terminalLine.cursorPosition = 0;
+            terminalLine_setString(&terminalLine, "");
         }
 
         //free memory
@@ -148,7 +154,51 @@ int shellUI(void)
 
     //cleanup before closing program
     //TODO: find way to cleanup local ptr variables when ctrl-c (make them global?)
-    free(terminalLine.string);
+    terminalLine_destroy(&terminalLine);
+    tokens_destroy(tokens);
+    return 0;
+}
+
+/*
+ * Function: shellUI_batch
+ * ----------------------------
+ *   Run every command read from 'input' until the end of the input or quit.
+ *   No terminal settings are changed, nothing is echoed and no prompt is printed.
+ *
+ *   input: stream to read commands from, one per line
+ *
+ *   returns: 0 if shell exited without error.
+ *            1 otherwise.
+ */
+int shellUI_batch(FILE* input)
+{
+    //register cleanup methods
+    atexit(shell_cleanup);
+
+    char *tokens[NUM_TOKENS] = {NULL};
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t lineLength;
+
+    while ((lineLength = getline(&line, &lineCapacity, input)) != -1)
+    {
+        //remove line ending
+        while (lineLength > 0 && (line[lineLength - 1] == '\n' || line[lineLength - 1] == '\r'))
+        {
+            line[--lineLength] = '\0';
+        }
+
+        TRACE_BEGIN("parse");
+        int parseError = parse(line, ' ', tokens);
+        TRACE_END("parse");
+        if (!parseError && interpreter(tokens) == -1)
+        {
+            break;
+        }
+        tokens_destroy(tokens);
+    }
+
+    free(line);
     tokens_destroy(tokens);
     return 0;
 }
@@ -169,16 +219,14 @@ int parse(char *string, char delimiter, char *tokens[])
 {
     if (getNumberOfOccurences('\"', string) % 2 == 1)
     {
-        setColor(RED);
-        printf("Parse error: Open quotation marks detected\n");
-        setColor(DEFAULT);
+        printColor(RED, "Parse error: Open quotation marks detected\n");
         tokens[0] = NULL;
         return 1;
     }
     char currentDelimiter = delimiter;
     char token[TOKENSIZE];
 
-    unsigned short stringPos = 0, curToken = 0, tokenPos;
+    int stringPos = 0, curToken = 0, tokenPos;
 
     while (*(string + stringPos) != '\0')
     {
@@ -203,9 +251,7 @@ int parse(char *string, char delimiter, char *tokens[])
                 token[10] = '\0';
                 strcat(token, "...");
                 //user input is too large to be considered a valid token
-                setColor(RED);
-                printf("Parse error: Invalid token: Token was too large \'%s\'\n", token);
-                setColor(DEFAULT);
+                printColor(RED, "Parse error: Invalid token: Token was too large \'%s\'\n", token);
                 tokens[curToken] = NULL;
                 return 1;
             }
@@ -225,9 +271,7 @@ int parse(char *string, char delimiter, char *tokens[])
             tokens[curToken++] = strdup(token);
         }
         else {
-            setColor(RED);
-            printf("Parse error: Number of tokens entered exceeded the maximum amount of %d\n", NUM_TOKENS);
-            setColor(DEFAULT);
+            printColor(RED, "Parse error: Number of tokens entered exceeded the maximum amount of %d\n", NUM_TOKENS);
             return 1;
         }
     }
@@ -245,12 +289,12 @@ int parse(char *string, char delimiter, char *tokens[])
  *      L/R arrow keys ->       move left/right along user input
  *      U/D arrow keys ->       navigate through command history
  *      Ctrl-L/R arrow keys ->  move left/right by one word along user input
+ *      Ctrl-R ->               search the command history
  * 
  *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
+ *                 the user input,
  *                 the cursor position relative to the user input.
- * 
- *   bufferSize:   maximum number of characters allowed per command
+ *                 The user input grows as needed: commands have no length limit.
  * 
  *   delimiter:    character that signals the end of a command
  *                 CANNOT BE TAB OR BACKSPACE
@@ -261,34 +305,41 @@ int parse(char *string, char delimiter, char *tokens[])
  *            1 to request a tab autocomplete opeation
  *           -1 to flag that callee should stop asking for user input
  */
-int getString(TERMINAL_LINE *terminalLine, int bufferSize, char delimiter, int echoON)
+int getString(TERMINAL_LINE *terminalLine, char delimiter, int echoON)
 {
-    setTerminalSettings();
+    //scripts run by the CPUs also read their lines through getString. Only the shell's own input
+    //needs the terminal settings changed; scripts must not touch them from other threads
+    int isTerminalInput = (terminalLine->inputStream == stdin);
+    if (isTerminalInput) {
+        setTerminalSettings();
+    }
 
-    //restore command if TAB was pressed
+    //draw the prompt. Restores the command if TAB was pressed
     int exitFlag = 0;
-    moveCursorToCursorPosition(terminalLine);
-    // terminalLine->string[terminalLine->cursorPosition] = '\0';
+    if (echoON) {
+        moveCursorToCursorPosition(terminalLine);
+    }
 
     //initialize variables
     int loopFlag = 0, validCharFlag = 0;
-    char c;
+    int c;
 
     //get user input until they trigger an exit condition
     while (!loopFlag)
     {
-        c = getc(terminalLine->inputStream);
-
-        while (detectEsc_and_ArrowKeys(terminalLine, &c) == 27)
-            ;
+        c = getKey(terminalLine);
         validCharFlag = character_isPrintable(c);
 
         switch (c)
         {
+        //navigation key, already handled by getKey
+        case 0:
+            break;
+
         //reached end of input stream (input was redirected or reading from file)
-        case -1:
+        case EOF:
             //if reached eof but the current line had some command, we should run it before exiting
-            if (strlen(terminalLine->string) == 0) {
+            if (terminalLine->length == 0) {
                 exitFlag = -1; //signal that we have reached the end of the input stream
             }
             loopFlag = 1;
@@ -297,33 +348,12 @@ int getString(TERMINAL_LINE *terminalLine, int bufferSize, char delimiter, int e
 
         //backspace (mimi terminal)
         case 8:
-            if (terminalLine->cursorPosition > 0)
-            {
-                printf("\b \b");
-                if (terminalLine->cursorPosition != strlen(terminalLine->string))
-                {
-                    deleteChar(terminalLine);
-                }
-                else
-                {
-                    terminalLine->string[strlen(terminalLine->string) - 1] = '\0';
-                    terminalLine->cursorPosition--;
-                }
-            }
+            deleteChar(terminalLine);
             break;
 
         //backspace
         case '\x7f':
-            if (terminalLine->cursorPosition > 0) {
-                printf("\b \b");
-                if (terminalLine->cursorPosition != strlen(terminalLine->string)) {
-                    deleteChar(terminalLine);
-                }
-                else {
-                    terminalLine->string[strlen(terminalLine->string) - 1] = '\0';
-                    terminalLine->cursorPosition--;
-                }
-            }
+            deleteChar(terminalLine);
             break;
 
         //tab
@@ -338,6 +368,7 @@ int getString(TERMINAL_LINE *terminalLine, int bufferSize, char delimiter, int e
                 loopFlag = 1;
                 validCharFlag = 0;
                 if (echoON) {
+                    refreshTerminalLine(terminalLine);  //keys pasted with the newline have not been drawn yet
                     putchar('\n');  //only print character if we want input to be shown
                 }
             }
@@ -349,45 +380,33 @@ int getString(TERMINAL_LINE *terminalLine, int bufferSize, char delimiter, int e
                 loopFlag = 1;
                 validCharFlag = 0;
                 if (echoON) {
+                    refreshTerminalLine(terminalLine);  //keys pasted with the newline have not been drawn yet
                     putchar('\n');  //only print character if we want input to be shown
                 }
                 break;
             }
 
-            //if character is valid and user command is not too long, append it to user command. 
-            if (strlen(terminalLine->string) < bufferSize - 1) {
-                if (validCharFlag) {
-                    if (terminalLine->cursorPosition == strlen(terminalLine->string)) {
-                        if (echoON) {   
-                            putchar(c); //only print character if we want input to be shown
-                        }
-                        terminalLine->string[strlen(terminalLine->string) + 1] = '\0';
-                        terminalLine->string[strlen(terminalLine->string)] = c;
-                        terminalLine->cursorPosition++;
-                    }
-                    else {
-                        insertChar(terminalLine, c);
-                    }
-                }
-            }
-            //User command is too long. Abort
-            else { 
-                loopFlag = 1;
-                terminalLine->string[0] = '\0';
-                setColor(RED);
-                printf("\nParse error: command was too long!\n");
-                setColor(DEFAULT);
+            //if character is valid, append it to user command
+            if (validCharFlag) {
+                insertChar(terminalLine, c);
             }
             break;
         }
+
+        //show the changes made by this keystroke. Pasted text is drawn once it has all been processed
+        if (echoON && !loopFlag && !hasPendingInput(terminalLine)) {
+            refreshTerminalLine(terminalLine);
+        }
     }
 
     //only save commands if user typed them from keyboard
-    if (exitFlag == 0 && strlen(terminalLine->string) > 0 && echoON) {  
-        history_saveString(terminalLine->string);
+    if (exitFlag == 0 && terminalLine->length > 0 && echoON) {  
+        history_saveString(terminalLine_getString(terminalLine));
     }
     
-    restoreTerminalSettings();
+    if (isTerminalInput) {
+        restoreTerminalSettings();
+    }
     return exitFlag;
 }
 
@@ -403,7 +422,7 @@ int getString(TERMINAL_LINE *terminalLine, int bufferSize, char delimiter, int e
  *   returns: wether or not the character is printable.
  */
 //detect unprintable characters
-static inline int character_isPrintable(char c)
+static inline int character_isPrintable(int c)
 {
     return (isalnum(c) || isspace(c) || ispunct(c));
 }
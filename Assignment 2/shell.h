@@ -4,11 +4,10 @@
 
     #define SHELL_PROMPT "$ "
     #define NUM_TOKENS 100
-    #define LINESIZE 300
     #define TOKENSIZE 200
 
     //call getString with '\n' as delimiter
-    #define getLine(a, b, c) getString(a, b, '\n', c)
+    #define getLine(a, b) getString(a, '\n', b)
 
     /*
     * Function: shellUI
@@ -25,6 +24,27 @@
     */
     extern int shellUI(void);
 
+    /*
+    * Function: shellUI_batch
+    * ----------------------------
+    *   Run every command read from 'input' until the end of the input or quit.
+    *   No terminal settings are changed, nothing is echoed and no prompt is printed.
+    *
+    *   input: stream to read commands from, one per line
+    *
+    *   returns: 0 if shell exited without error.
+    *            1 otherwise.
+    */
+    extern int shellUI_batch(FILE* input);
+
+    /*
+    * Function: restoreTerminalSettings
+    * ----------------------------
+    *   Restores the OS terminal settings to what they were before this
+    *   program ran. Only calls tcsetattr, so it is safe inside a signal handler.
+    */
+    extern void restoreTerminalSettings();
+
     /*
     * Function: parse
     * ----------------------------
@@ -50,12 +70,12 @@
     *      L/R arrow keys ->       move left/right along user input
     *      U/D arrow keys ->       navigate through command history
     *      Ctrl-L/R arrow keys ->  move left/right by one word along user input
+    *      Ctrl-R ->               search the command history
     * 
     *   terminalLine: stores the input stream to read from,
-    *                 the character array to store user input into, 
+    *                 the user input,
     *                 the cursor position relative to the user input.
-    * 
-    *   bufferSize:   maximum number of characters allowed per command
+    *                 The user input grows as needed: commands have no length limit.
     * 
     *   delimiter:    character that signals the end of a command
     *                 CANNOT BE TAB OR BACKSPACE
@@ -66,7 +86,7 @@
     *            1 to request a tab autocomplete opeation
     *           -1 to flag that callee should stop asking for user input
     */
-    extern int getString(TERMINAL_LINE* terminalLine, int bufferSize, char delimiter, int echoON);
+    extern int getString(TERMINAL_LINE* terminalLine, char delimiter, int echoON);
 
     /*
     * Function: tokens_destroy
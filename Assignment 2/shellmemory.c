@@ -1,14 +1,26 @@
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include "shellmemory.h"
+#include "stringset.h"
 
 // SHELL MEMORY ///////////////////////////////////////////////
 #define MEMORY_SIZE 1000
+#define MEMORY_SHARDS 16
 
 /*
  * This structure is used to store shell variables.
  * Variables are a key value pair.
  * Shell memory is implemented as a dictionary.  
+ * A variable whose slot was reserved by internVar() but that was never set has a NULL value.
  */
 static struct MEM
 {
@@ -16,24 +28,114 @@ static struct MEM
     char *value;
 } SHELLMEMORY;
 
-static struct MEM consoleMemory[MEMORY_SIZE];
-static size_t mem_HEAD = 0;
+/*
+ * Scripts running on different CPUs access the shell memory at the same time.
+ * Variables are spread across shards based on the hash of their name. Every shard
+ * has its own reader-writer lock: reads never block each other, and writes only
+ * block accesses to variables of the same shard.
+ */
+struct memoryShard
+{
+    pthread_rwlock_t lock;
+    struct MEM variables[MEMORY_SIZE];
+    size_t mem_HEAD;
+};
+
+/*
+ * Variables never move once created, until the memory is cleared. A slot identifies a variable
+ * by its shard and its index in the shard: shard * MEMORY_SIZE + index.
+ */
+static struct memoryShard consoleMemory[MEMORY_SHARDS] = {[0 ... MEMORY_SHARDS - 1] = {.lock = PTHREAD_RWLOCK_INITIALIZER}};
+static atomic_size_t mem_COUNT = 0;    //number of variables holding a value across all shards
 
-static int createVar(char *var, char *value);
-static int findVar(char *var);
+static int createVar(struct memoryShard *shard, char *var);
+static int assignVar(struct memoryShard *shard, int variableIndex, char *value);
+static int findVar(struct memoryShard *shard, char *var);
+static struct memoryShard *getShard(char *var);
 
 // SHELL COMMAND HISTORY //////////////////////////////////////
-#define HISTORY_SIZE 100
+#define HISTORY_MAP_RESERVE (1 << 20)   //bytes mapped past the end of the history file, so appends rarely need a new mapping
+#define COMMANDS_INITIAL_SIZE 64        //distinct commands the history holds before growing
+#define TRIGRAM_BUCKETS (1 << 16)       //number of lists in the trigram index. Must be a power of 2
+#define TRIGRAM_LIST_INITIAL_SIZE 4
+#define EMPTY_SLOT -1
+
+/*
+ * Command history is kept in an append-only file, one command per line, shared by every
+ * session using the same file. The file is memory mapped and only the last historySize
+ * commands are indexed: historyEntries[] is a ring holding the command each of them refers to.
+ * Opening the history only reads the lines it indexes, not the whole file.
+ * Commands are appended with a single write() and the mapping is larger than the file.
+ *
+ * Commands are interned: every distinct command is stored once in historyCommands[], with the
+ * number of history entries referring to it, and is found from its text through commandTable.
+ * Entering a command again only adds a reference to it, and a command entered twice in a row is
+ * only saved once. The memory used by the history grows with the number of distinct commands.
+ */
+struct historyCommand
+{
+    off_t offset;               //position of the command in the history file
+    int length;                 //length of the command, without the newline
+    unsigned long hash;
+    int references;             //number of history entries referring to the command. 0 if the slot is free
+    unsigned int searchStamp;   //equal to searchGeneration if the command contains the query of the current search
+};
+
+static int historyFile = -1;
+static FILE *historyTemporaryFile = NULL;   //used when the history file could not be opened
+static char *historyMap = NULL;
+static size_t historyMapSize = 0;
+static int *historyEntries = NULL;          //indexes in historyCommands[]
+static int historySize = 0;     //number of commands indexed
+static int hist_FIRST = 0;      //ring index of the oldest command
+static int hist_COUNT = 0;      //number of commands in historyEntries[]
+static int hist_POS = 0;        //user position in the history. hist_COUNT when at the command being typed
+static char *hist_DRAFT = NULL; //command being typed when the user started navigating the history
+static char *hist_STRING = NULL;    //last command returned by the history, NUL terminated
+static size_t hist_STRING_CAPACITY = 0;
+
+static struct historyCommand *historyCommands = NULL;
+static int commandsCapacity = 0;
+static int commandsUsed = 0;        //slots of historyCommands[] used so far, including free ones
+static int *freeCommands = NULL;    //stack of free slots of historyCommands[]
+static int freeCommandsCount = 0;
+static int *commandTable = NULL;    //hash table (linear probing) of indexes in historyCommands[]
+static int commandTableCapacity = 0;    //power of 2, at least twice the number of distinct commands
+static int commandCount = 0;        //number of distinct commands
+
+static int history_mapFile(size_t fileSize);
+static void history_indexFile(size_t fileSize);
+static struct historyCommand *history_getCommand(int position);
+static char *history_getString(int position);
+static int history_internCommand(off_t offset, int length);
+static void history_releaseCommand(int command);
+static int history_findCommand(const char *string, int length, unsigned long hash);
+static void history_insertCommand(int command);
+static int history_commandEquals(int command, const char *string, int length);
+static unsigned long history_hash(const char *string, int length);
+
+/*
+ * The trigram index lets history_search() only look at commands containing a trigram (3 consecutive
+ * characters) of the query. Trigrams are hashed into TRIGRAM_BUCKETS lists holding the indexes of
+ * the commands containing them. Different trigrams can share a list and a free slot can be reused
+ * by another command, so commands found through a list are always checked against the query.
+ * The index is built on the first search and then updated when a new command is interned.
+ */
+struct trigramList
+{
+    int *commands;
+    int length;
+    int capacity;
+};
 
-static char *commandHistory[HISTORY_SIZE] = {NULL};
-static int hist_HEAD = 0;
-static int hist_TAIL = 0;
-static int hist_POS = 0;
+static struct trigramList *trigramIndex = NULL;
+static unsigned int searchGeneration = 0;
 
-static int history_saveString_noIncrement(char *string);
-static int history_incrementVariable(int *variable);
-static int history_decrementVariable(int *variable);
-static int history_incrementHEAD();
+static void trigramIndex_build();
+static void trigramIndex_addCommand(int command);
+static void trigramList_add(struct trigramList *list, int command);
+static struct trigramList *trigramIndex_getList(const char *trigram);
+static int history_contains(int command, const char *query, int queryLength);
 
 
 /*
@@ -49,29 +151,22 @@ static int history_incrementHEAD();
  */
 int setVar(char *var, char *value)
 {
-    int variableIndex = findVar(var);
+    struct memoryShard *shard = getShard(var);
+    int error = 1;
+    pthread_rwlock_wrlock(&shard->lock);
+    int variableIndex = findVar(shard, var);
     //variable does not exist. Need to create it
     if (variableIndex == -1)
     {
-        variableIndex = createVar(var, value);
-        //could not create variable b/c no more space
-        if (variableIndex == -1)
-        {
-            return 1;
-        }
-        else
-        {
-            return 0;
-        }
+        variableIndex = createVar(shard, var);
     }
-    else
+    //could not create variable b/c no more space
+    if (variableIndex != -1)
     {
-        //delete previous value
-        free(consoleMemory[variableIndex].value);
-        //set variable value
-        consoleMemory[variableIndex].value = strdup(value);
-        return 0;
+        error = assignVar(shard, variableIndex, value);
     }
+    pthread_rwlock_unlock(&shard->lock);
+    return error;
 }
 
 /*
@@ -86,12 +181,87 @@ int setVar(char *var, char *value)
  */
 char *getVar(char *var)
 {
-    int variableIndex = findVar(var);
+    struct memoryShard *shard = getShard(var);
+    char *value = NULL;
+    pthread_rwlock_rdlock(&shard->lock);
+    int variableIndex = findVar(shard, var);
+    if (variableIndex != -1 && shard->variables[variableIndex].value != NULL)
+    {
+        value = strdup(shard->variables[variableIndex].value);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    return value;
+}
+
+/*
+ * Function: internVar
+ * ----------------------------
+ *   Returns the slot of variable 'var', reserving one if the variable does not exist.
+ *   Reserving a slot does not create the variable: it does not exist until it is set.
+ *   The slot stays valid until memory_clear() is called.
+ *
+ *   var: name of variable
+ *
+ *   returns: the slot of variable 'var'.
+ *            -1 if there is no room left to reserve a slot.
+ */
+int internVar(char *var)
+{
+    struct memoryShard *shard = getShard(var);
+    pthread_rwlock_wrlock(&shard->lock);
+    int variableIndex = findVar(shard, var);
     if (variableIndex == -1)
     {
-        return NULL;
+        variableIndex = createVar(shard, var);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    if (variableIndex == -1)
+    {
+        return -1;
+    }
+    return (shard - consoleMemory) * MEMORY_SIZE + variableIndex;
+}
+
+/*
+ * Function: setVarSlot
+ * ----------------------------
+ *   Behaves exactly like setVar, for the variable stored in 'slot'.
+ *
+ *   slot: slot of the variable, returned by internVar()
+ *   value: value to assign to variable
+ *
+ *   returns: whether or not the operation was successful
+ */
+int setVarSlot(int slot, char *value)
+{
+    struct memoryShard *shard = &consoleMemory[slot / MEMORY_SIZE];
+    pthread_rwlock_wrlock(&shard->lock);
+    int error = assignVar(shard, slot % MEMORY_SIZE, value);
+    pthread_rwlock_unlock(&shard->lock);
+    return error;
+}
+
+/*
+ * Function: getVarSlot
+ * ----------------------------
+ *   Behaves exactly like getVar, for the variable stored in 'slot'.
+ *
+ *   slot: slot of the variable, returned by internVar()
+ *
+ *   returns: the value of the variable. 
+ *            NULL if the variable was never set.
+ */
+char *getVarSlot(int slot)
+{
+    struct memoryShard *shard = &consoleMemory[slot / MEMORY_SIZE];
+    char *value = NULL;
+    pthread_rwlock_rdlock(&shard->lock);
+    if (shard->variables[slot % MEMORY_SIZE].value != NULL)
+    {
+        value = strdup(shard->variables[slot % MEMORY_SIZE].value);
     }
-    return strdup(consoleMemory[variableIndex].value);
+    pthread_rwlock_unlock(&shard->lock);
+    return value;
 }
 
 /*
@@ -102,28 +272,53 @@ char *getVar(char *var)
 *   returns: whether the operation was successful or not
 */
 int memory_clear() {
-    for (int i = 0; i < mem_HEAD; i++) {
-        free(consoleMemory[i].var);
-        free(consoleMemory[i].value);
+    for (int shard = 0; shard < MEMORY_SHARDS; shard++) {
+        pthread_rwlock_wrlock(&consoleMemory[shard].lock);
+        size_t count = 0;
+        for (int i = 0; i < consoleMemory[shard].mem_HEAD; i++) {
+            count += (consoleMemory[shard].variables[i].value != NULL);
+            free(consoleMemory[shard].variables[i].var);
+            free(consoleMemory[shard].variables[i].value);
+        }
+        atomic_fetch_sub(&mem_COUNT, count);
+        consoleMemory[shard].mem_HEAD = 0;
+        pthread_rwlock_unlock(&consoleMemory[shard].lock);
     }
     return 0;
 }
 
+/*
+ * Function: getShard
+ * ----------------------------
+ *   Returns the shard that stores variable var.
+ *   The shard is picked using the djb2 hash of the variable name.
+ *
+ *   var: name of variable
+ *
+ *   returns: the shard that stores variable var
+ */
+static struct memoryShard *getShard(char *var)
+{
+    return &consoleMemory[stringSet_hash(var) % MEMORY_SHARDS];
+}
+
 /*
  * Function: findVar
  * ----------------------------
- *   Returns the index of variable var in consoleMemory[] array
+ *   Returns the index of variable var in the shard's variables[] array.
+ *   The caller must hold the shard lock.
  *
+ *   shard: the shard that stores variable var
  *   var: name of variable
  *
  *   returns: index of variable var.
  *            -1 if var does not exist.
  */
-static int findVar(char *var)
+static int findVar(struct memoryShard *shard, char *var)
 {
-    for (int i = 0; i < mem_HEAD; i++)
+    for (int i = 0; i < shard->mem_HEAD; i++)
     {
-        if (!strcmp(consoleMemory[i].var, var))
+        if (!strcmp(shard->variables[i].var, var))
         {
             return i;
         }
@@ -134,31 +329,99 @@ static int findVar(char *var)
 /*
  * Function: createVar
  * ----------------------------
- *   Update the consoleMemory[] array by adding the new variable to
- *   the head of the array and updating the head.
+ *   Update the shard's variables[] array by adding the new variable to
+ *   the head of the array and updating the head. The variable has no value yet.
+ *   The caller must hold the shard write lock.
  *
+ *   shard: the shard that stores variable var
  *   var: name of variable
- *   value: value to assign to variable
  *
  *   returns: the index of the newly created variable
- *            -1 if consoleMemory[] is full and variable could not be created
+ *            -1 if the shard is full and variable could not be created
  */
-static int createVar(char *var, char *value)
+static int createVar(struct memoryShard *shard, char *var)
 {
-    if (mem_HEAD == MEMORY_SIZE)
+    if (shard->mem_HEAD == MEMORY_SIZE)
     {
         return -1;
     }
-    consoleMemory[mem_HEAD].var = strdup(var);
-    consoleMemory[mem_HEAD].value = strdup(value);
-    mem_HEAD++;
-    return mem_HEAD - 1;
+    shard->variables[shard->mem_HEAD].var = strdup(var);
+    shard->variables[shard->mem_HEAD].value = NULL;
+    shard->mem_HEAD++;
+    return shard->mem_HEAD - 1;
+}
+
+/*
+ * Function: assignVar
+ * ----------------------------
+ *   Replace the value of the variable at index variableIndex of the shard's variables[] array.
+ *   The caller must hold the shard write lock.
+ *
+ *   shard: the shard that stores the variable
+ *   variableIndex: index of the variable
+ *   value: value to assign to variable
+ *
+ *   returns: 0 if successful
+ *            1 if the variable had no value and shell memory is full
+ */
+static int assignVar(struct memoryShard *shard, int variableIndex, char *value)
+{
+    struct MEM *variable = &shard->variables[variableIndex];
+    //reserve space for the value of a new variable. MEMORY_SIZE is shared by all shards
+    if (variable->value == NULL && atomic_fetch_add(&mem_COUNT, 1) >= MEMORY_SIZE)
+    {
+        atomic_fetch_sub(&mem_COUNT, 1);
+        return 1;
+    }
+    //delete previous value
+    free(variable->value);
+    //set variable value
+    variable->value = strdup(value);
+    return 0;
+}
+
+/*
+ * Function: history_open
+ * ----------------------------
+ *   Open the history file and index its last 'size' commands.
+ *   If the file cannot be opened, the history is kept in a temporary file
+ *   and is lost when the shell exits.
+ *
+ *   filename: history file. Created if it does not exist
+ *   size: maximum number of commands the history can navigate through
+ *
+ *   returns: 0 if the history file was opened, 1 if a temporary file is used instead
+ */
+int history_open(const char *filename, int size)
+{
+    history_clear();
+    int error = 0;
+    historyFile = filename != NULL ? open(filename, O_RDWR | O_APPEND | O_CREAT, 0600) : -1;
+    if (historyFile < 0)
+    {
+        error = 1;
+        historyTemporaryFile = tmpfile();
+        historyFile = historyTemporaryFile != NULL ? dup(fileno(historyTemporaryFile)) : -1;
+    }
+
+    historySize = size > 0 ? size : 1;
+    historyEntries = (int *)malloc(sizeof(int) * historySize);
+
+    struct stat fileStatus;
+    if (historyFile < 0 || fstat(historyFile, &fileStatus) || history_mapFile(fileStatus.st_size))
+    {
+        return 1;
+    }
+    history_indexFile(fileStatus.st_size);
+    return error;
 }
 
 /*
  * Function: history_saveString
  * ----------------------------
- *   Save the string to the head of commandHistory[] and update the head.
+ *   Append the string to the history file and index it.
+ *   The oldest command is no longer indexed once historySize commands are.
+ *   The string is not saved if it is the last command saved.
  *
  *   string: the string to save to memory
  *
@@ -166,65 +429,95 @@ static int createVar(char *var, char *value)
  */
 int history_saveString(char *string)
 {
-    if (commandHistory[hist_HEAD] != NULL)
+    if (historyMap == NULL)
+    {
+        return 1;
+    }
+    int length = strlen(string);
+    if (hist_COUNT == 0 || !history_commandEquals(historyEntries[(hist_FIRST + hist_COUNT - 1) % historySize], string, length))
     {
-        free(commandHistory[hist_HEAD]);
+        //the command and its newline are appended with a single write, even if another session appends at the same time
+        struct iovec line[2] = {{string, length}, {"\n", 1}};
+        ssize_t written;
+        while ((written = writev(historyFile, line, 2)) < 0 && errno == EINTR)
+            ;
+        if (written != length + 1)
+        {
+            return 1;
+        }
+        off_t fileSize = lseek(historyFile, 0, SEEK_CUR);
+        if ((size_t)fileSize > historyMapSize && history_mapFile(fileSize))
+        {
+            return 1;
+        }
+
+        if (hist_COUNT == historySize)
+        {
+            history_releaseCommand(historyEntries[hist_FIRST]);
+            hist_FIRST = (hist_FIRST + 1) % historySize;
+            hist_COUNT--;
+        }
+        historyEntries[(hist_FIRST + hist_COUNT) % historySize] = history_internCommand(fileSize - length - 1, length);
+        hist_COUNT++;
     }
-    commandHistory[hist_HEAD] = strdup(string);
-    history_incrementHEAD();
-    hist_POS = hist_HEAD; //reset user position to HEAD of history
+
+    hist_POS = hist_COUNT; //reset user position to the command being typed
+    free(hist_DRAFT);
+    hist_DRAFT = NULL;
     return 0;
 }
 
 /*
  * Function: history_getPrevious
  * ----------------------------
- *   Returns the string located at hist_POS -1. update hist_POS.
+ *   Returns the command before hist_POS. update hist_POS.
  * 
- *   if hist_POS == hist_TAIL, we have reached the oldest command 
- *   stored in commandHistory[]. Do not update hist_POS and return
- *   commandHistory[hist_TAIL].
+ *   If hist_POS is the oldest command indexed, do not update 
+ *   hist_POS and return it again.
  * 
- *   If hist_POS == hist_HEAD, we save the parameter 'string'
+ *   If hist_POS is at the command being typed, we save the parameter 'string'
  *   to allow the user to navigate back to the command they
- *   were typing before viewing commands saved in commandHistory[]
+ *   were typing before viewing commands saved in history
  *
  *   string: current string displayed on terminal
  *
- *   returns: the previous command stored in commandHistory[] relative
+ *   returns: the previous command stored in history relative
  *            to the user's position in the history hist_POS.
+ *            Valid until the next call to the history.
  */
 char *history_getPrevious(char *string)
 {
-    if (hist_POS == hist_HEAD)
+    if (hist_POS == hist_COUNT)
     {
-        history_saveString_noIncrement(string);
+        free(hist_DRAFT);
+        hist_DRAFT = strdup(string);
     }
-    if (hist_POS != hist_TAIL)
+    if (hist_POS > 0)
     {
-        history_decrementVariable(&hist_POS);
+        hist_POS--;
     }
-    return commandHistory[hist_POS];
+    return history_getString(hist_POS);
 }
 
 /*
  * Function: history_getNext
  * ----------------------------
- *   Returns the string located at hist_POS + 1. update hist_POS.
- *   if hist_POS == hist_HEAD, return the parameter 'string' as
- *   no next history command exists.
+ *   Returns the command after hist_POS. update hist_POS.
+ *   if hist_POS is at the command being typed, return the parameter
+ *   'string' as no next history command exists.
  * 
  *   string: current string displayed on terminal
  *
- *   returns: the next command stored in commandHistory[] relative
+ *   returns: the next command stored in history relative
  *            to the user's position in the history hist_POS.
+ *            Valid until the next call to the history.
  */
 char *history_getNext(char *string)
 {
-    if (hist_POS != hist_HEAD)
+    if (hist_POS < hist_COUNT)
     {
-        history_incrementVariable(&hist_POS);
-        return commandHistory[hist_POS];
+        hist_POS++;
+        return history_getString(hist_POS);
     }
     else
     {
@@ -232,99 +525,565 @@ char *history_getNext(char *string)
     }
 }
 
+/*
+ * Function: history_search
+ * ----------------------------
+ *   Returns the most recent command containing 'query', among the commands
+ *   located before 'position' in the history.
+ *
+ *   Every distinct command is checked against the query once: queries of 3 characters
+ *   or more only check the commands listed by the trigram index under the rarest trigram
+ *   of the query, shorter queries check all of them. The history is then searched
+ *   backwards for a command that matched.
+ *
+ *   query: the text to look for
+ *   position: search the commands before *position. -1 to search the whole history.
+ *             Set to the position of the command found.
+ *
+ *   returns: the command found, valid until the next call to the history.
+ *            NULL if no command contains 'query'.
+ */
+char *history_search(const char *query, int *position)
+{
+    int queryLength = strlen(query);
+    int end = (*position < 0 || *position > hist_COUNT) ? hist_COUNT : *position;
+    if (queryLength == 0 || historyMap == NULL)
+    {
+        return NULL;
+    }
+
+    searchGeneration++;
+    int matches = 0;
+    if (queryLength < 3)
+    {
+        for (int command = 0; command < commandsUsed; command++)
+        {
+            if (historyCommands[command].references > 0 && history_contains(command, query, queryLength))
+            {
+                historyCommands[command].searchStamp = searchGeneration;
+                matches++;
+            }
+        }
+    }
+    else
+    {
+        if (trigramIndex == NULL)
+        {
+            trigramIndex_build();
+        }
+        struct trigramList *rarest = trigramIndex_getList(query);
+        for (int i = 1; i + 3 <= queryLength; i++)
+        {
+            struct trigramList *list = trigramIndex_getList(query + i);
+            if (list->length < rarest->length)
+            {
+                rarest = list;
+            }
+        }
+        for (int i = 0; i < rarest->length; i++)
+        {
+            struct historyCommand *command = &historyCommands[rarest->commands[i]];
+            if (command->references > 0 && command->searchStamp != searchGeneration
+                && history_contains(rarest->commands[i], query, queryLength))
+            {
+                command->searchStamp = searchGeneration;
+                matches++;
+            }
+        }
+    }
+    if (matches == 0)
+    {
+        return NULL;
+    }
+
+    for (int candidate = end - 1; candidate >= 0; candidate--)
+    {
+        if (history_getCommand(candidate)->searchStamp == searchGeneration)
+        {
+            *position = candidate;
+            return history_getString(candidate);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Function: history_getRecent
+ * ----------------------------
+ *   Returns a command without changing the user position in the history.
+ *
+ *   age: number of commands entered after it. 0 is the most recent command.
+ *
+ *   returns: the command, valid until the next call to the history.
+ *            NULL if the history holds 'age' commands or fewer.
+ */
+char *history_getRecent(int age)
+{
+    if (age < 0 || age >= hist_COUNT)
+    {
+        return NULL;
+    }
+    return history_getString(hist_COUNT - 1 - age);
+}
+
 /*
  * Function: history_clear
  * ----------------------------
- *   Frees all memory allocated to command history
+ *   Unmaps and closes the history file and frees the history index
  *
  *   returns: whether the operation was successful or not
  */
 int history_clear() {
-    for (int i = 0; i < HISTORY_SIZE; i++) {
-        if (commandHistory[i] != NULL){
-            free(commandHistory[i]);
+    if (historyMap != NULL)
+    {
+        munmap(historyMap, historyMapSize);
+        historyMap = NULL;
+        historyMapSize = 0;
+    }
+    if (historyFile >= 0)
+    {
+        close(historyFile);
+        historyFile = -1;
+    }
+    if (historyTemporaryFile != NULL)
+    {
+        fclose(historyTemporaryFile);
+        historyTemporaryFile = NULL;
+    }
+    if (trigramIndex != NULL)
+    {
+        for (int i = 0; i < TRIGRAM_BUCKETS; i++)
+        {
+            free(trigramIndex[i].commands);
         }
+        free(trigramIndex);
+        trigramIndex = NULL;
     }
+    free(historyEntries);
+    free(historyCommands);
+    free(freeCommands);
+    free(commandTable);
+    free(hist_DRAFT);
+    free(hist_STRING);
+    historyEntries = NULL;
+    historyCommands = NULL;
+    freeCommands = NULL;
+    commandTable = NULL;
+    hist_DRAFT = NULL;
+    hist_STRING = NULL;
+    hist_STRING_CAPACITY = 0;
+    hist_FIRST = hist_COUNT = hist_POS = 0;
+    commandsCapacity = commandsUsed = freeCommandsCount = commandTableCapacity = commandCount = 0;
     return 0;
 }
 
 /*
- * Function: history_saveString_noIncrement
+ * Function: history_mapFile
  * ----------------------------
- *   Used in history_getPrevious(). 
- *   Behaves exactly like history_saveString, except that
- *   hist_HEAD is not incremented.
+ *   Map the history file, with HISTORY_MAP_RESERVE bytes past its end so the
+ *   commands appended next can be read without mapping the file again.
+ *   Bytes past the end of the file are never read.
  *
- *   string: string to save
+ *   fileSize: current size of the history file
  *
  *   returns: whether the operation was successful or not
  */
-static int history_saveString_noIncrement(char *string)
+static int history_mapFile(size_t fileSize)
 {
-    if (commandHistory[hist_HEAD] != NULL)
+    if (historyMap != NULL)
+    {
+        munmap(historyMap, historyMapSize);
+    }
+    historyMapSize = fileSize + HISTORY_MAP_RESERVE;
+    historyMap = mmap(NULL, historyMapSize, PROT_READ, MAP_SHARED, historyFile, 0);
+    if (historyMap == MAP_FAILED)
     {
-        free(commandHistory[hist_HEAD]);
+        historyMap = NULL;
+        historyMapSize = 0;
+        return 1;
     }
-    commandHistory[hist_HEAD] = strdup(string);
     return 0;
 }
 
 /*
- * Function: history_incrementHEAD
+ * Function: history_indexFile
  * ----------------------------
- *   Increment the hist_HEAD variable using the following operation:
- *   hist_HEAD = (hist_HEAD + 1) % HISTORY_SIZE
- * 
- *   Increment history_TAIL if history_HEAD ==  history_TAIL.
- *   This is done in order for the commandHistory array to behave
- *   like a circular array
+ *   Index the last historySize commands of the history file.
+ *   The file is read backwards from its end, so only the indexed lines are read.
+ *   Empty lines and lines equal to the next line are skipped.
  *
- *   returns: the new value of history_HEAD
+ *   fileSize: current size of the history file
  */
-static int history_incrementHEAD()
+static void history_indexFile(size_t fileSize)
 {
-    if (history_incrementVariable(&hist_HEAD) == hist_TAIL)
+    //the ring is filled from its end, so the oldest command indexed ends up at hist_FIRST
+    size_t end = fileSize;
+    int newerCommand = EMPTY_SLOT;
+    while (end > 0 && hist_COUNT < historySize)
     {
-        history_incrementVariable(&hist_TAIL);
+        size_t lineEnd = historyMap[end - 1] == '\n' ? end - 1 : end;
+        size_t start = lineEnd;
+        while (start > 0 && historyMap[start - 1] != '\n')
+        {
+            start--;
+        }
+        int length = lineEnd - start;
+        if (length > 0 && (newerCommand == EMPTY_SLOT || !history_commandEquals(newerCommand, historyMap + start, length)))
+        {
+            newerCommand = history_internCommand(start, length);
+            hist_COUNT++;
+            historyEntries[historySize - hist_COUNT] = newerCommand;
+        }
+        end = start;
     }
-    return hist_HEAD;
+    hist_FIRST = historySize - hist_COUNT;
+    hist_POS = hist_COUNT;
 }
 
 /*
- * Function: history_incrementVariable
+ * Function: history_getCommand
  * ----------------------------
- *   Increment the 'variable' variable using the following operation:
- *   variable = (variable + 1) % variable
+ *   Returns the command an entry of the history refers to.
  *
- *   variable: variable to increment
- * 
- *   returns: the new value of variable
+ *   position: position of the entry in the history. 0 is the oldest command indexed
+ *
+ *   returns: the command
  */
-static int history_incrementVariable(int *variable)
+static struct historyCommand *history_getCommand(int position)
 {
-    *variable = (*variable + 1) % HISTORY_SIZE;
-    return *variable;
+    return &historyCommands[historyEntries[(hist_FIRST + position) % historySize]];
 }
 
 /*
- * Function: history_decrementVariable
+ * Function: history_getString
  * ----------------------------
- *   Decrement the 'variable' variable using the following operation:
- *   variable = (variable - 1) % variable
+ *   Copy a command out of the history file into hist_STRING and terminate it with NUL.
  *
- *   variable: variable to decrement
- * 
- *   returns: the new value of variable
+ *   position: position of the command in the history. hist_COUNT for the command being typed
+ *
+ *   returns: the command. Valid until the next call to the history.
+ */
+static char *history_getString(int position)
+{
+    if (position == hist_COUNT)
+    {
+        return hist_DRAFT;
+    }
+    struct historyCommand *command = history_getCommand(position);
+    if (command->length + 1 > hist_STRING_CAPACITY)
+    {
+        hist_STRING_CAPACITY = (command->length + 1) * 2;
+        hist_STRING = (char *)realloc(hist_STRING, hist_STRING_CAPACITY);
+    }
+    memcpy(hist_STRING, historyMap + command->offset, command->length);
+    hist_STRING[command->length] = '\0';
+    return hist_STRING;
+}
+
+/*
+ * Function: history_internCommand
+ * ----------------------------
+ *   Returns the interned command equal to the text located at 'offset' in the history file,
+ *   with one more reference. The command is created if it was never interned.
+ *
+ *   offset: position of the command in the history file
+ *   length: length of the command
+ *
+ *   returns: the index of the command in historyCommands[]
  */
-static int history_decrementVariable(int *variable)
+static int history_internCommand(off_t offset, int length)
 {
-    if (*variable == 0)
+    const char *string = historyMap + offset;
+    unsigned long hash = history_hash(string, length);
+    int command = history_findCommand(string, length, hash);
+    if (command != EMPTY_SLOT)
+    {
+        historyCommands[command].references++;
+        return command;
+    }
+
+    if (freeCommandsCount > 0)
     {
-        *variable = HISTORY_SIZE - 1;
+        command = freeCommands[--freeCommandsCount];
     }
     else
     {
-        *variable = *variable - 1;
+        if (commandsUsed == commandsCapacity)
+        {
+            commandsCapacity = commandsCapacity > 0 ? commandsCapacity * 2 : COMMANDS_INITIAL_SIZE;
+            historyCommands = (struct historyCommand *)realloc(historyCommands, sizeof(struct historyCommand) * commandsCapacity);
+            freeCommands = (int *)realloc(freeCommands, sizeof(int) * commandsCapacity);
+        }
+        command = commandsUsed++;
+    }
+    historyCommands[command] = (struct historyCommand){.offset = offset, .length = length, .hash = hash, .references = 1, .searchStamp = 0};
+
+    //keep the table at most half full
+    if ((commandCount + 1) * 2 > commandTableCapacity)
+    {
+        int *oldTable = commandTable;
+        int oldCapacity = commandTableCapacity;
+        commandTableCapacity = commandTableCapacity > 0 ? commandTableCapacity * 2 : COMMANDS_INITIAL_SIZE * 2;
+        commandTable = (int *)malloc(sizeof(int) * commandTableCapacity);
+        for (int i = 0; i < commandTableCapacity; i++)
+        {
+            commandTable[i] = EMPTY_SLOT;
+        }
+        for (int i = 0; i < oldCapacity; i++)
+        {
+            if (oldTable[i] != EMPTY_SLOT)
+            {
+                history_insertCommand(oldTable[i]);
+            }
+        }
+        free(oldTable);
+    }
+    history_insertCommand(command);
+    commandCount++;
+
+    if (trigramIndex != NULL)
+    {
+        trigramIndex_addCommand(command);
+    }
+    return command;
+}
+
+/*
+ * Function: history_releaseCommand
+ * ----------------------------
+ *   Remove a reference to an interned command. The command is removed from
+ *   the hash table and its slot is freed once no history entry refers to it.
+ *   Entries following it in the table are moved back, so lookups never need to skip deleted entries.
+ *
+ *   command: index of the command in historyCommands[]
+ */
+static void history_releaseCommand(int command)
+{
+    if (--historyCommands[command].references > 0)
+    {
+        return;
+    }
+    int mask = commandTableCapacity - 1;
+    int hole = historyCommands[command].hash & mask;
+    while (commandTable[hole] != command)
+    {
+        hole = (hole + 1) & mask;
+    }
+    for (int next = (hole + 1) & mask; commandTable[next] != EMPTY_SLOT; next = (next + 1) & mask)
+    {
+        int home = historyCommands[commandTable[next]].hash & mask;
+        //move the entry into the hole unless its home position is cyclically between the hole and the entry
+        int homeAfterHole = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+        if (!homeAfterHole)
+        {
+            commandTable[hole] = commandTable[next];
+            hole = next;
+        }
+    }
+    commandTable[hole] = EMPTY_SLOT;
+    freeCommands[freeCommandsCount++] = command;
+    commandCount--;
+}
+
+/*
+ * Function: history_findCommand
+ * ----------------------------
+ *   Find an interned command from its text.
+ *
+ *   string: text of the command, not NUL terminated
+ *   length: length of the command
+ *   hash: history_hash() of the command
+ *
+ *   returns: the index of the command in historyCommands[]. EMPTY_SLOT if it is not interned
+ */
+static int history_findCommand(const char *string, int length, unsigned long hash)
+{
+    if (commandTableCapacity == 0)
+    {
+        return EMPTY_SLOT;
+    }
+    int mask = commandTableCapacity - 1;
+    for (int i = hash & mask; commandTable[i] != EMPTY_SLOT; i = (i + 1) & mask)
+    {
+        if (historyCommands[commandTable[i]].hash == hash && history_commandEquals(commandTable[i], string, length))
+        {
+            return commandTable[i];
+        }
+    }
+    return EMPTY_SLOT;
+}
+
+/*
+ * Function: history_insertCommand
+ * ----------------------------
+ *   Add an interned command to the first free position of the hash table after its hash.
+ *
+ *   command: index of the command in historyCommands[]
+ */
+static void history_insertCommand(int command)
+{
+    int mask = commandTableCapacity - 1;
+    int i = historyCommands[command].hash & mask;
+    while (commandTable[i] != EMPTY_SLOT)
+    {
+        i = (i + 1) & mask;
     }
-    return *variable;
+    commandTable[i] = command;
+}
+
+/*
+ * Function: history_commandEquals
+ * ----------------------------
+ *   Returns whether an interned command is equal to 'string'.
+ *
+ *   command: index of the command in historyCommands[]
+ *   string: text to compare, not NUL terminated
+ *   length: length of string
+ *
+ *   returns: 1 if they are equal, 0 otherwise
+ */
+static int history_commandEquals(int command, const char *string, int length)
+{
+    return historyCommands[command].length == length && !memcmp(historyMap + historyCommands[command].offset, string, length);
+}
+
+/*
+ * Function: history_hash
+ * ----------------------------
+ *   Returns the djb2 hash of a command, like stringSet_hash() but for text that is not NUL terminated.
+ *
+ *   string: text of the command
+ *   length: length of the command
+ *
+ *   returns: the hash of the command
+ */
+static unsigned long history_hash(const char *string, int length)
+{
+    unsigned long hash = 5381;
+    for (int i = 0; i < length; i++)
+    {
+        hash = hash * 33 + (unsigned char)string[i];
+    }
+    return hash;
+}
+
+/*
+ * Function: history_contains
+ * ----------------------------
+ *   Returns whether an interned command contains 'query'.
+ *   The command is read directly from the history file.
+ *
+ *   command: index of the command in historyCommands[]
+ *   query: the text to look for
+ *   queryLength: length of query
+ *
+ *   returns: 1 if the command contains query, 0 otherwise
+ */
+static int history_contains(int command, const char *query, int queryLength)
+{
+    struct historyCommand *entry = &historyCommands[command];
+    if (entry->length < queryLength)
+    {
+        return 0;
+    }
+    const char *text = historyMap + entry->offset;
+    const char *last = text + entry->length - queryLength; //last position query can start at
+    for (const char *start = text; start <= last; start++)
+    {
+        start = memchr(start, query[0], last - start + 1);
+        if (start == NULL)
+        {
+            return 0;
+        }
+        if (!memcmp(start, query, queryLength))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Function: trigramIndex_build
+ * ----------------------------
+ *   Create the trigram index and add every interned command to it.
+ */
+static void trigramIndex_build()
+{
+    trigramIndex = (struct trigramList *)calloc(TRIGRAM_BUCKETS, sizeof(struct trigramList));
+    for (int command = 0; command < commandsUsed; command++)
+    {
+        if (historyCommands[command].references > 0)
+        {
+            trigramIndex_addCommand(command);
+        }
+    }
+}
+
+/*
+ * Function: trigramIndex_addCommand
+ * ----------------------------
+ *   Add an interned command to the lists of all its trigrams.
+ *
+ *   command: index of the command in historyCommands[]
+ */
+static void trigramIndex_addCommand(int command)
+{
+    const char *text = historyMap + historyCommands[command].offset;
+    for (int i = 0; i + 3 <= historyCommands[command].length; i++)
+    {
+        struct trigramList *list = trigramIndex_getList(text + i);
+        //a trigram can appear more than once in the same command
+        if (list->length == 0 || list->commands[list->length - 1] != command)
+        {
+            trigramList_add(list, command);
+        }
+    }
+}
+
+/*
+ * Function: trigramList_add
+ * ----------------------------
+ *   Append a command to a trigram list. When the list is full, the
+ *   free slots are removed from it before it is grown.
+ *
+ *   list: the list to add the command to
+ *   command: index of the command in historyCommands[]
+ */
+static void trigramList_add(struct trigramList *list, int command)
+{
+    if (list->length == list->capacity)
+    {
+        int kept = 0;
+        for (int i = 0; i < list->length; i++)
+        {
+            if (historyCommands[list->commands[i]].references > 0)
+            {
+                list->commands[kept++] = list->commands[i];
+            }
+        }
+        list->length = kept;
+        if (list->length == list->capacity)
+        {
+            list->capacity = list->capacity > 0 ? list->capacity * 2 : TRIGRAM_LIST_INITIAL_SIZE;
+            list->commands = (int *)realloc(list->commands, sizeof(int) * list->capacity);
+        }
+    }
+    list->commands[list->length++] = command;
+}
+
+/*
+ * Function: trigramIndex_getList
+ * ----------------------------
+ *   Returns the list of the trigram made of the first 3 characters of 'trigram'.
+ *
+ *   trigram: the characters to hash
+ *
+ *   returns: the list of commands that may contain the trigram
+ */
+static struct trigramList *trigramIndex_getList(const char *trigram)
+{
+    unsigned int hash = ((unsigned char)trigram[0] << 16) | ((unsigned char)trigram[1] << 8) | (unsigned char)trigram[2];
+    hash *= 2654435761u; //Knuth's multiplicative hash spreads similar trigrams across buckets
+    return &trigramIndex[hash >> 16 & (TRIGRAM_BUCKETS - 1)];
 }
\ No newline at end of file
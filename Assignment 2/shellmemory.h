@@ -26,6 +26,44 @@
     */
     extern char *getVar(char *var);
 
+    /*
+    * Function: internVar
+    * ----------------------------
+    *   Returns the slot of variable 'var', reserving one if the variable does not exist.
+    *   Reserving a slot does not create the variable: it does not exist until it is set.
+    *   The slot stays valid until memory_clear() is called.
+    *
+    *   var: name of variable
+    *
+    *   returns: the slot of variable 'var'.
+    *            -1 if there is no room left to reserve a slot.
+    */
+    extern int internVar(char *var);
+
+    /*
+    * Function: setVarSlot
+    * ----------------------------
+    *   Behaves exactly like setVar, for the variable stored in 'slot'.
+    *
+    *   slot: slot of the variable, returned by internVar()
+    *   value: value to assign to variable
+    *
+    *   returns: whether or not the operation was successful
+    */
+    extern int setVarSlot(int slot, char *value);
+
+    /*
+    * Function: getVarSlot
+    * ----------------------------
+    *   Behaves exactly like getVar, for the variable stored in 'slot'.
+    *
+    *   slot: slot of the variable, returned by internVar()
+    *
+    *   returns: the value of the variable. 
+    *            NULL if the variable was never set.
+    */
+    extern char *getVarSlot(int slot);
+
     /*
     * Function: memory_clear
     * ----------------------------
@@ -36,10 +74,27 @@
     extern int memory_clear();
 
 // SHELL COMMAND HISTORY //////////////////////////////////////
+    #define HISTORY_SIZE 10000              //default number of commands the history can navigate through
+    #define HISTORY_FILENAME ".mykernel_history"    //default history file, in the home directory
+
+    /*
+    * Function: history_open
+    * ----------------------------
+    *   Open the history file and index its last 'size' commands.
+    *   If the file cannot be opened, the history is kept in a temporary file
+    *   and is lost when the shell exits.
+    *
+    *   filename: history file. Created if it does not exist
+    *   size: maximum number of commands the history can navigate through
+    *
+    *   returns: 0 if the history file was opened, 1 if a temporary file is used instead
+    */
+    extern int history_open(const char *filename, int size);
+
     /*
     * Function: history_saveString
     * ----------------------------
-    *   Save the string to shell command history
+    *   Append the string to the shell command history file
     *
     *   string: the string to save to memory
     *
@@ -58,6 +113,7 @@
     *
     *   returns: the previous command stored in shell command history relative
     *            to the user's position in the history.
+    *            Valid until the next call to the history.
     */
     extern char *history_getPrevious(char *string);
 
@@ -71,13 +127,41 @@
     *
     *   returns: the next command stored in shell command history relative
     *            to the user's position in the history.
+    *            Valid until the next call to the history.
+    */
+    extern char *history_getNext(char *string);
+
+    /*
+    * Function: history_search
+    * ----------------------------
+    *   Returns the most recent command containing 'query', among the commands
+    *   located before 'position' in the history.
+    *
+    *   query: the text to look for
+    *   position: search the commands before *position. -1 to search the whole history.
+    *             Set to the position of the command found.
+    *
+    *   returns: the command found, valid until the next call to the history.
+    *            NULL if no command contains 'query'.
+    */
+    extern char *history_search(const char *query, int *position);
+
+    /*
+    * Function: history_getRecent
+    * ----------------------------
+    *   Returns a command without changing the user position in the history.
+    *
+    *   age: number of commands entered after it. 0 is the most recent command.
+    *
+    *   returns: the command, valid until the next call to the history.
+    *            NULL if the history holds 'age' commands or fewer.
     */
-    extern char *history_getNext();
+    extern char *history_getRecent(int age);
 
     /*
     * Function: history_clear
     * ----------------------------
-    *   Frees all memory allocated to command history
+    *   Unmaps and closes the history file and frees the history index
     *
     *   returns: whether the operation was successful or not
     */
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "terminal-io.h"
+#include "stats.h"
+
+struct statsRecord {
+    int pid;
+    char* name;
+    struct processStats stats;
+};
+
+//statistics of terminated processes, in order of termination
+static struct statsRecord* records = NULL;
+static int numberOfRecords = 0;
+static int recordsCapacity = 0;
+static pthread_mutex_t recordsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void getTotals(struct processStats* totals);
+static void writeJSONString(FILE* file, const char* string);
+static void writeJSONStats(FILE* file, const struct processStats* stats);
+
+/*
+ * Function: stats_now
+ * ----------------------------
+ *   Return a monotonic timestamp in nanoseconds.
+ */
+long long stats_now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+/*
+ * Function: stats_record
+ * ----------------------------
+ *   Save the statistics of a process that terminated.
+ *
+ *   pid: ID of the process
+ *   name: name of the script the process ran
+ *   stats: statistics of the process
+ */
+void stats_record(int pid, const char* name, const struct processStats* stats) {
+    pthread_mutex_lock(&recordsLock);
+    if (numberOfRecords == recordsCapacity) {
+        recordsCapacity = recordsCapacity ? recordsCapacity * 2 : 16;
+        records = (struct statsRecord*) realloc(records, sizeof(struct statsRecord) * recordsCapacity);
+    }
+    records[numberOfRecords].pid = pid;
+    records[numberOfRecords].name = strdup(name);
+    records[numberOfRecords].stats = *stats;
+    numberOfRecords++;
+    pthread_mutex_unlock(&recordsLock);
+}
+
+/*
+ * Function: stats_print
+ * ----------------------------
+ *   Print the statistics of every terminated process as a table, followed by totals.
+ *   Times are printed in microseconds.
+ */
+void stats_print() {
+    pthread_mutex_lock(&recordsLock);
+    if (numberOfRecords == 0) {
+        pthread_mutex_unlock(&recordsLock);
+        printf("No process has terminated yet\n");
+        return;
+    }
+
+    printf("%4s  %-20s %10s %12s %12s %12s %12s %14s\n", "PID", "SCRIPT", "DISPATCHES", "INSTRUCTIONS",
+           "WAIT(us)", "RUN(us)", "SWITCH(us)", "TURNAROUND(us)");
+    for (int i = 0; i < numberOfRecords; i++) {
+        struct processStats* stats = &records[i].stats;
+        printf("%4d  %-20s %10ld %12ld %12.1f %12.1f %12.1f %14.1f\n", records[i].pid, records[i].name,
+               stats->dispatches, stats->instructions, stats->waitTime / 1000.0, stats->runTime / 1000.0,
+               stats->switchTime / 1000.0, stats->turnaroundTime / 1000.0);
+    }
+
+    struct processStats totals;
+    getTotals(&totals);
+    printColor(YELLOW, "%4s  %-20s %10ld %12ld %12.1f %12.1f %12.1f %14.1f\n", "", "total", totals.dispatches, totals.instructions,
+           totals.waitTime / 1000.0, totals.runTime / 1000.0, totals.switchTime / 1000.0, totals.turnaroundTime / 1000.0);
+    pthread_mutex_unlock(&recordsLock);
+}
+
+/*
+ * Function: stats_writeJSON
+ * ----------------------------
+ *   Write the statistics of every terminated process to a file as JSON.
+ *
+ *   filename: name of the file to write
+ *
+ *   return: 0 if successful. 1 if the file could not be written.
+ */
+int stats_writeJSON(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        printColor(RED, "stats: could not write to \'%s\'\n", filename);
+        return 1;
+    }
+
+    pthread_mutex_lock(&recordsLock);
+    fprintf(file, "{\"processes\": [");
+    for (int i = 0; i < numberOfRecords; i++) {
+        fprintf(file, "%s\n  {\"pid\": %d, \"name\": ", i ? "," : "", records[i].pid);
+        writeJSONString(file, records[i].name);
+        fprintf(file, ", ");
+        writeJSONStats(file, &records[i].stats);
+        fprintf(file, "}");
+    }
+    struct processStats totals;
+    getTotals(&totals);
+    fprintf(file, "\n], \"totals\": {\"processes\": %d, ", numberOfRecords);
+    writeJSONStats(file, &totals);
+    fprintf(file, "}}\n");
+    pthread_mutex_unlock(&recordsLock);
+
+    fclose(file);
+    return 0;
+}
+
+/*
+ * Function: stats_clear
+ * ----------------------------
+ *   Free all saved statistics.
+ */
+void stats_clear() {
+    pthread_mutex_lock(&recordsLock);
+    for (int i = 0; i < numberOfRecords; i++) {
+        free(records[i].name);
+    }
+    free(records);
+    records = NULL;
+    numberOfRecords = 0;
+    recordsCapacity = 0;
+    pthread_mutex_unlock(&recordsLock);
+}
+
+/*
+ * Function: getTotals
+ * ----------------------------
+ *   Sum the statistics of every terminated process.
+ *   The caller must hold recordsLock.
+ *
+ *   totals: where to store the sums
+ */
+static void getTotals(struct processStats* totals) {
+    memset(totals, 0, sizeof(struct processStats));
+    for (int i = 0; i < numberOfRecords; i++) {
+        totals->dispatches += records[i].stats.dispatches;
+        totals->instructions += records[i].stats.instructions;
+        totals->waitTime += records[i].stats.waitTime;
+        totals->runTime += records[i].stats.runTime;
+        totals->switchTime += records[i].stats.switchTime;
+        totals->turnaroundTime += records[i].stats.turnaroundTime;
+    }
+}
+
+/*
+ * Function: writeJSONStats
+ * ----------------------------
+ *   Write the counters of a processStats structure as JSON object members.
+ *
+ *   file: the file to write to
+ *   stats: the statistics to write
+ */
+static void writeJSONStats(FILE* file, const struct processStats* stats) {
+    fprintf(file, "\"dispatches\": %ld, \"instructions\": %ld, \"wait_ns\": %lld, \"run_ns\": %lld, "
+            "\"switch_ns\": %lld, \"turnaround_ns\": %lld", stats->dispatches, stats->instructions,
+            stats->waitTime, stats->runTime, stats->switchTime, stats->turnaroundTime);
+}
+
+/*
+ * Function: writeJSONString
+ * ----------------------------
+ *   Write a string as a quoted JSON string, escaping special characters.
+ *
+ *   file: the file to write to
+ *   string: the string to write
+ */
+static void writeJSONString(FILE* file, const char* string) {
+    fputc('"', file);
+    for (; *string != '\0'; string++) {
+        if (*string == '"' || *string == '\\') {
+            fputc('\\', file);
+            fputc(*string, file);
+        } else if ((unsigned char) *string < 0x20) {
+            fprintf(file, "\\u%04x", *string);
+        } else {
+            fputc(*string, file);
+        }
+    }
+    fputc('"', file);
+}
\ No newline at end of file
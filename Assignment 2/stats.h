@@ -0,0 +1,62 @@
+#ifndef STATS_HEADER
+    #define STATS_HEADER
+    #include <stdio.h>
+
+    /*
+     * Scheduler telemetry of a single process. Times are in nanoseconds.
+     * Only the CPU currently holding the process updates its statistics.
+    */
+    struct processStats {
+        long dispatches;            //number of times the process was moved to a CPU
+        long instructions;          //number of instructions the process completed
+        long long waitTime;         //time spent waiting in a ready queue
+        long long runTime;          //time spent executing instructions
+        long long switchTime;       //time spent moving the process to/from a CPU
+        long long turnaroundTime;   //time between loading the process and terminating it
+        long long loadedAt;         //timestamp of when the process was loaded
+        long long readySince;       //timestamp of when the process last entered a ready queue
+    };
+
+    /*
+    * Function: stats_now
+    * ----------------------------
+    *   Return a monotonic timestamp in nanoseconds.
+    */
+    extern long long stats_now();
+
+    /*
+    * Function: stats_record
+    * ----------------------------
+    *   Save the statistics of a process that terminated.
+    *
+    *   pid: ID of the process
+    *   name: name of the script the process ran
+    *   stats: statistics of the process
+    */
+    extern void stats_record(int pid, const char* name, const struct processStats* stats);
+
+    /*
+    * Function: stats_print
+    * ----------------------------
+    *   Print the statistics of every terminated process as a table, followed by totals.
+    */
+    extern void stats_print();
+
+    /*
+    * Function: stats_writeJSON
+    * ----------------------------
+    *   Write the statistics of every terminated process to a file as JSON.
+    *
+    *   filename: name of the file to write
+    *
+    *   return: 0 if successful. 1 if the file could not be written.
+    */
+    extern int stats_writeJSON(const char* filename);
+
+    /*
+    * Function: stats_clear
+    * ----------------------------
+    *   Free all saved statistics.
+    */
+    extern void stats_clear();
+#endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <string.h>
+#include "stringset.h"
+
+static void growSet(struct stringSet* set);
+
+/*
+ * Function: stringSet_init
+ * ----------------------------
+ *   Initialize an empty set able to hold expectedSize strings without growing.
+ *
+ *   set: the set to initialize
+ *   expectedSize: number of strings we expect to add to the set
+ */
+void stringSet_init(struct stringSet* set, size_t expectedSize) {
+    //keep the set at most half full to keep probing sequences short
+    set->capacity = 16;
+    while (set->capacity < expectedSize * 2) {
+        set->capacity *= 2;
+    }
+    set->slots = (const char**) calloc(set->capacity, sizeof(char*));
+    set->size = 0;
+}
+
+/*
+ * Function: stringSet_add
+ * ----------------------------
+ *   Add string to the set if it is not already in it.
+ *
+ *   set: the set to add the string to
+ *   string: the string to add
+ *
+ *   return: 1 if the string was added. 0 if it was already in the set.
+ */
+int stringSet_add(struct stringSet* set, const char* string) {
+    if ((set->size + 1) * 2 > set->capacity) {
+        growSet(set);
+    }
+
+    //capacity is a power of 2: the mask replaces the modulo
+    size_t slot = stringSet_hash(string) & (set->capacity - 1);
+    while (set->slots[slot] != NULL) {
+        if (!strcmp(set->slots[slot], string)) {
+            return 0;
+        }
+        slot = (slot + 1) & (set->capacity - 1);
+    }
+    set->slots[slot] = string;
+    set->size++;
+    return 1;
+}
+
+/*
+ * Function: stringSet_destroy
+ * ----------------------------
+ *   Free the memory used by the set. The strings themselves are not freed.
+ *
+ *   set: the set to destroy
+ */
+void stringSet_destroy(struct stringSet* set) {
+    free(set->slots);
+    set->slots = NULL;
+    set->capacity = 0;
+    set->size = 0;
+}
+
+/*
+ * Function: stringSet_hash
+ * ----------------------------
+ *   Return the djb2 hash of string.
+ *
+ *   string: the string to hash
+ *
+ *   return: the hash of string
+ */
+unsigned long stringSet_hash(const char* string) {
+    unsigned long hash = 5381;
+    for (; *string != '\0'; string++) {
+        hash = hash * 33 + (unsigned char) *string;
+    }
+    return hash;
+}
+
+/*
+ * Function: growSet
+ * ----------------------------
+ *   Double the capacity of the set and insert its strings again.
+ *
+ *   set: the set to grow
+ */
+static void growSet(struct stringSet* set) {
+    const char** oldSlots = set->slots;
+    size_t oldCapacity = set->capacity;
+
+    set->capacity *= 2;
+    set->slots = (const char**) calloc(set->capacity, sizeof(char*));
+    set->size = 0;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i] != NULL) {
+            stringSet_add(set, oldSlots[i]);
+        }
+    }
+    free(oldSlots);
+}
@@ -0,0 +1,56 @@
+#ifndef STRINGSET_HEADER
+    #define STRINGSET_HEADER
+    #include <stddef.h>
+
+    /*
+     * Hash set of strings using open addressing (linear probing).
+     * The set only stores pointers: strings must stay allocated while they are in the set.
+    */
+    struct stringSet {
+        const char** slots;
+        size_t capacity;
+        size_t size;
+    };
+
+    /*
+    * Function: stringSet_init
+    * ----------------------------
+    *   Initialize an empty set able to hold expectedSize strings without growing.
+    *
+    *   set: the set to initialize
+    *   expectedSize: number of strings we expect to add to the set
+    */
+    extern void stringSet_init(struct stringSet* set, size_t expectedSize);
+
+    /*
+    * Function: stringSet_add
+    * ----------------------------
+    *   Add string to the set if it is not already in it.
+    *
+    *   set: the set to add the string to
+    *   string: the string to add
+    *
+    *   return: 1 if the string was added. 0 if it was already in the set.
+    */
+    extern int stringSet_add(struct stringSet* set, const char* string);
+
+    /*
+    * Function: stringSet_destroy
+    * ----------------------------
+    *   Free the memory used by the set. The strings themselves are not freed.
+    *
+    *   set: the set to destroy
+    */
+    extern void stringSet_destroy(struct stringSet* set);
+
+    /*
+    * Function: stringSet_hash
+    * ----------------------------
+    *   Return the djb2 hash of string.
+    *
+    *   string: the string to hash
+    *
+    *   return: the hash of string
+    */
+    extern unsigned long stringSet_hash(const char* string);
+#endif
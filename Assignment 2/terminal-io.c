@@ -1,29 +1,121 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
 #include "shellmemory.h"
 #include "terminal-io.h"
 
+#define INPUT_BUFFER_SIZE 4096      //bytes of shell input read ahead
+#define ESCAPE_TIMEOUT_MS 50        //time to wait for the rest of an escape sequence before treating ESC as a key
+#define ESCAPE_SEQUENCE_SIZE 8      //longest escape sequence, ESC excluded, plus 1
+#define ESC 27
+#define INPUT_TIMEOUT -2            //returned by readByte() when no input arrived in time
+#define CTRL_G 7                    //cancels the history search
+#define CTRL_R 18                   //starts the history search, or finds the next older match
+#define LINE_INITIAL_CAPACITY 64    //characters of user input a new terminal line can hold before growing
 
-/* supported shell text colors */
-char* color[NUM_COLORS] = {[RED] = "\033[0;31m", [BLUE] = "\033[0;34m", [YELLOW] = "\033[1;33m", [DEFAULT] = "\033[0m"};
+/* supported shell text colors. The length of every escape sequence is stored to write it without parsing a format */
+#define COLOR_CODE(code) {code, sizeof(code) - 1}
+static const struct {
+    const char* code;
+    size_t length;
+} color[NUM_COLORS] = {[RED] = COLOR_CODE("\033[0;31m"), [BLUE] = COLOR_CODE("\033[0;34m"),
+                       [YELLOW] = COLOR_CODE("\033[1;33m"), [DEFAULT] = COLOR_CODE("\033[0m")};
 
-//update user input/terminal
-static void clearTerminalLine(int strLength);
-static void refreshTerminal(TERMINAL_LINE* terminalLine);
-static void printStringFrom(const char* const string, int start);
+//in batch mode, no color or cursor escape sequence is written and the terminal line is never redrawn
+static int batchMode = 0;
+//colors are only written to a terminal. See terminal_detectColors()
+static int colorsEnabled = 1;
+
+//draw the terminal line
+static void render_append(const char* data, size_t length);
+static void render_appendCursorMove(int moveBy, char direction);
+static void render_flush();
+
+/* keys that move the cursor or navigate the command history */
+enum NAVIGATION_KEYS {
+    KEY_IGNORED, KEY_UP, KEY_DOWN, KEY_RIGHT, KEY_LEFT, KEY_WORD_RIGHT, KEY_WORD_LEFT
+};
+
+/*
+ * Escape sequences sent by the terminal for navigation keys, without the initial ESC.
+ * getKey() reads the input one byte at a time until it matches one entry of this table.
+*/
+static const struct {
+    const char* sequence;
+    enum NAVIGATION_KEYS key;
+} escapeSequences[] = {
+    {"[A", KEY_UP}, {"[B", KEY_DOWN}, {"[C", KEY_RIGHT}, {"[D", KEY_LEFT},
+    {"OA", KEY_UP}, {"OB", KEY_DOWN}, {"OC", KEY_RIGHT}, {"OD", KEY_LEFT},
+    //Shift, Ctrl and Ctrl-Shift arrow keys
+    {"[1;2C", KEY_WORD_RIGHT}, {"[1;2D", KEY_WORD_LEFT}, {"[1;2A", KEY_IGNORED}, {"[1;2B", KEY_IGNORED},
+    {"[1;5C", KEY_WORD_RIGHT}, {"[1;5D", KEY_WORD_LEFT}, {"[1;5A", KEY_IGNORED}, {"[1;5B", KEY_IGNORED},
+    {"[1;6C", KEY_WORD_RIGHT}, {"[1;6D", KEY_WORD_LEFT}, {"[1;6A", KEY_IGNORED}, {"[1;6B", KEY_IGNORED}
+};
+
+/*
+ * Shell input read ahead from STDIN. read() fills it with everything available,
+ * so pasted text is processed without a system call per character.
+*/
+static struct {
+    char data[INPUT_BUFFER_SIZE];
+    size_t start;   //index of the next byte to read
+    size_t length;  //number of bytes waiting to be read
+} inputBuffer;
+
+//read keys
+static int readByte(TERMINAL_LINE* terminalLine, int timeout);
+static int input_fill(int timeout);
+static void handleNavigationKey(TERMINAL_LINE* terminalLine, enum NAVIGATION_KEYS key);
+
+//reverse incremental history search (Ctrl-R)
+static int searchHistory(TERMINAL_LINE* terminalLine);
+static int searchHistory_findMatch(TERMINAL_LINE* terminalLine, TERMINAL_LINE* query, int* position, int searchBefore);
+static void searchHistory_draw(TERMINAL_LINE* terminalLine, TERMINAL_LINE* query, int failed);
 
 //move cursor methods
-static void event_arrowKey(TERMINAL_LINE* terminalLine, char* c);
-static void event_arrowKey_ctrl(TERMINAL_LINE* terminalLine, char* c);
-static void event_arrowKey_shift(TERMINAL_LINE* terminalLine, char* c);
-static void event_arrowKey_ctrl_shift(TERMINAL_LINE* terminalLine, char* c);
-static void jumpToPreviousWord(const char* const string, int* currentPos);
-static void jumpToNextWord(const char* const string, int* currentPos);
-static void moveCursorLeft(int moveBy, const char* const string, int* currentPos);
-static void moveCursorRight(int moveBy, const char* const string, int* currentPos);
-static void moveCursor(int moveBy, char direction);
+static void jumpToPreviousWord(TERMINAL_LINE* terminalLine);
+static void jumpToNextWord(TERMINAL_LINE* terminalLine);
+static void moveCursorLeft(int moveBy, TERMINAL_LINE* terminalLine);
+static void moveCursorRight(int moveBy, TERMINAL_LINE* terminalLine);
+
+//gap buffer methods
+static char charAt(TERMINAL_LINE* terminalLine, int position);
+static void moveGap(TERMINAL_LINE* terminalLine, int position);
+static void growLine(TERMINAL_LINE* terminalLine, int minimumCapacity);
+
+/*
+ * Everything written to redraw the terminal line is first collected in this buffer,
+ * then sent to the terminal with a single write(). This avoids a stdio call per character
+ * and the flicker of partially drawn lines.
+*/
+static struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} renderBuffer = {NULL, 0, 0};
+
+/*
+ * What the terminal currently shows: the length of the user input drawn after the prompt
+ * and the cursor position. With the firstChange of the terminal line, lets
+ * refreshTerminalLine() redraw only what changed.
+ * renderedLineStale is set by terminal_outputWritten() when something else was written,
+ * such as the output of background processes: the line is then redrawn entirely.
+*/
+static struct {
+    int length;
+    int cursorPosition;
+} renderedLine = {0, 0};
+static atomic_int renderedLineStale = 1;
+
+static void render_saveLine(TERMINAL_LINE* terminalLine);
+static void render_appendLine(TERMINAL_LINE* terminalLine, int from, int to);
+static void render_appendCursorMoveTo(int from, int to);
 
 /*
  * Function: setColor
@@ -31,51 +123,318 @@ static void moveCursor(int moveBy, char direction);
  *   Change the color of text written to STDOUT
  */
 void setColor(int colorIndex) {
-    printf("%s", color[colorIndex]);
+    if (!colorsEnabled) {
+        return;
+    }
+    fwrite(color[colorIndex].code, 1, color[colorIndex].length, stdout);
+}
+
+/*
+ * Function: printColor
+ * ----------------------------
+ *   printf() a message in color, then switch back to the default color.
+ *   The color codes and the message are written while holding the lock on STDOUT,
+ *   so messages printed by other CPUs cannot end up in between.
+ *
+ *   colorIndex: color of the message
+ *   format: printf() format of the message, followed by its arguments
+ */
+void printColor(int colorIndex, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    if (!colorsEnabled) {
+        vprintf(format, arguments);
+    } else {
+        flockfile(stdout);
+        fwrite(color[colorIndex].code, 1, color[colorIndex].length, stdout);
+        vprintf(format, arguments);
+        fwrite(color[DEFAULT].code, 1, color[DEFAULT].length, stdout);
+        funlockfile(stdout);
+    }
+    va_end(arguments);
+    terminal_outputWritten();
+}
+
+/*
+ * Function: terminal_outputWritten
+ * ----------------------------
+ *   Signal that something other than the terminal line was written to STDOUT,
+ *   so the next refreshTerminalLine() redraws the prompt and the entire line.
+ *   Can be called by any thread.
+ */
+void terminal_outputWritten() {
+    //most calls find the flag already set: only reading it keeps the flag out of the CPUs' way
+    if (!atomic_load_explicit(&renderedLineStale, memory_order_relaxed)) {
+        atomic_store_explicit(&renderedLineStale, 1, memory_order_relaxed);
+    }
+}
+
+/*
+ * Function: terminal_detectColors
+ * ----------------------------
+ *   Only write colors when STDOUT is a terminal and the NO_COLOR
+ *   environment variable is not set (https://no-color.org).
+ *   Must be called before any thread other than the main thread is created.
+ */
+void terminal_detectColors() {
+    const char* noColor = getenv("NO_COLOR");
+    colorsEnabled = isatty(STDOUT_FILENO) && (noColor == NULL || noColor[0] == '\0');
+}
+
+/*
+ * Function: terminal_setBatchMode
+ * ----------------------------
+ *   Enable or disable batch mode. In batch mode, setColor() does nothing
+ *   and the terminal line is never redrawn.
+ *
+ *   enabled: whether batch mode is enabled
+ */
+void terminal_setBatchMode(int enabled) {
+    batchMode = enabled;
+    if (enabled) {
+        colorsEnabled = 0;
+    }
+}
+
+/*
+ * Function: terminal_isBatchMode
+ * ----------------------------
+ *   return: whether batch mode is enabled
+ */
+int terminal_isBatchMode() {
+    return batchMode;
+}
+
+/*
+ * Function: terminalLine_init
+ * ----------------------------
+ *   Initialize an empty terminal line.
+ *
+ *   terminalLine: the terminal line to initialize
+ *   inputStream: the input stream to read user input from
+ */
+void terminalLine_init(TERMINAL_LINE* terminalLine, FILE* inputStream) {
+    terminalLine->inputStream = inputStream;
+    terminalLine->buffer = (char*) malloc(LINE_INITIAL_CAPACITY);
+    terminalLine->capacity = LINE_INITIAL_CAPACITY;
+    terminalLine->length = 0;
+    terminalLine->gapStart = 0;
+    terminalLine->cursorPosition = 0;
+    terminalLine->firstChange = 0;
+}
+
+/*
+ * Function: terminalLine_destroy
+ * ----------------------------
+ *   Free the memory used by the terminal line.
+ *
+ *   terminalLine: the terminal line to destroy
+ */
+void terminalLine_destroy(TERMINAL_LINE* terminalLine) {
+    free(terminalLine->buffer);
+    terminalLine->buffer = NULL;
+    terminalLine->capacity = 0;
+    terminalLine->length = 0;
+    terminalLine->gapStart = 0;
+}
+
+/*
+ * Function: terminalLine_getString
+ * ----------------------------
+ *   Return the user input as a string. The gap is moved to the end of the
+ *   user input so the characters are contiguous, and the string is terminated
+ *   inside the gap. The string is only valid until the line is edited.
+ *
+ *   terminalLine: the terminal line to read
+ *
+ *   return: the user input
+ */
+char* terminalLine_getString(TERMINAL_LINE* terminalLine) {
+    growLine(terminalLine, terminalLine->length + 1);
+    moveGap(terminalLine, terminalLine->length);
+    terminalLine->buffer[terminalLine->length] = '\0';
+    return terminalLine->buffer;
+}
+
+/*
+ * Function: terminalLine_setString
+ * ----------------------------
+ *   Replace the user input with 'string' and move the cursor to its end.
+ *   'string' may be a string returned by terminalLine_getString().
+ *
+ *   terminalLine: the terminal line to change
+ *   string: the new user input
+ */
+void terminalLine_setString(TERMINAL_LINE* terminalLine, const char* string) {
+    int length = strlen(string);
+    if (length + 1 > terminalLine->capacity) {
+        //'string' cannot be inside the buffer: it would not fit
+        growLine(terminalLine, length + 1);
+    }
+    memmove(terminalLine->buffer, string, length);
+    terminalLine->length = length;
+    terminalLine->gapStart = length;
+    terminalLine->cursorPosition = length;
+    terminalLine->firstChange = 0;
+}
+
+/*
+ * Function: terminalLine_setCursor
+ * ----------------------------
+ *   Move the cursor. The position is limited to the user input.
+ *
+ *   terminalLine: the terminal line to change
+ *   cursorPosition: the new cursor position relative to the user input
+ */
+void terminalLine_setCursor(TERMINAL_LINE* terminalLine, int cursorPosition) {
+    if (cursorPosition < 0) {
+        cursorPosition = 0;
+    } else if (cursorPosition > terminalLine->length) {
+        cursorPosition = terminalLine->length;
+    }
+    terminalLine->cursorPosition = cursorPosition;
+}
+
+/*
+ * Function: terminalLine_replace
+ * ----------------------------
+ *   Replace 'length' characters of the user input starting at 'position' with 'string'.
+ *   The gap is moved after the replaced characters and grown over them, then
+ *   'string' is written at its start. The cursor is not moved.
+ *
+ *   terminalLine: the terminal line to change
+ *   position: position of the first character to replace
+ *   length: number of characters to replace. 0 inserts 'string' at 'position'.
+ *   string: the text to write in their place. Must not point inside the terminal line.
+ */
+void terminalLine_replace(TERMINAL_LINE* terminalLine, int position, int length, const char* string) {
+    int stringLength = strlen(string);
+    moveGap(terminalLine, position + length);
+    terminalLine->gapStart = position;
+    terminalLine->length -= length;
+    growLine(terminalLine, terminalLine->length + stringLength);
+    memcpy(terminalLine->buffer + position, string, stringLength);
+    terminalLine->gapStart += stringLength;
+    terminalLine->length += stringLength;
+    if (position < terminalLine->firstChange) {
+        terminalLine->firstChange = position;
+    }
+    if (terminalLine->cursorPosition > terminalLine->length) {
+        terminalLine->cursorPosition = terminalLine->length;
+    }
 }
 
 /*
  * Function: insertChar
  * ----------------------------
  *   Insert the character 'c' at cursor position.
- *   Update the user input and terminal to reflect the change.
+ *   The gap is moved to the cursor, then the character is written at its start:
+ *   consecutive insertions at the same position do not move any other character.
+ *   The terminal is updated by the next call to refreshTerminalLine().
  *
  *   c: character to insert
  *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
+ *                 the user input,
  *                 the cursor position relative to the user input.
  */
 void insertChar(TERMINAL_LINE* terminalLine, char c){
-    int previousLength = strlen(terminalLine->string);
-    terminalLine->string[previousLength + 1] = '\0';
-    for (int curChar = previousLength; curChar > terminalLine->cursorPosition; curChar--){
-        terminalLine->string[curChar] = terminalLine->string[curChar-1];
+    growLine(terminalLine, terminalLine->length + 1);
+    moveGap(terminalLine, terminalLine->cursorPosition);
+    terminalLine->buffer[terminalLine->gapStart] = c;
+    terminalLine->gapStart++;
+    terminalLine->length++;
+    if (terminalLine->cursorPosition < terminalLine->firstChange) {
+        terminalLine->firstChange = terminalLine->cursorPosition;
     }
-    terminalLine->string[terminalLine->cursorPosition] = c;
-    putchar(c);
-    terminalLine->cursorPosition = terminalLine->cursorPosition + 1;
-    refreshTerminal(terminalLine);
+    terminalLine->cursorPosition++;
 }
 
 /*
  * Function: deleteChar
  * ----------------------------
  *   Delete the character located to the left of the cursor.
- *   Update the user input and terminal to reflect the change.
+ *   The gap is moved to the cursor and grows over the deleted character.
+ *   The terminal is updated by the next call to refreshTerminalLine().
  *
  *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
+ *                 the user input,
  *                 the cursor position relative to the user input.
  */
 void deleteChar(TERMINAL_LINE* terminalLine){
     if (terminalLine->cursorPosition <= 0){
         return;
     }
-    for (int curChar = terminalLine->cursorPosition - 1; terminalLine->string[curChar] != '\0'; curChar++){
-        terminalLine->string[curChar] = terminalLine->string[curChar+1];
+    moveGap(terminalLine, terminalLine->cursorPosition);
+    terminalLine->gapStart--;
+    terminalLine->length--;
+    terminalLine->cursorPosition--;
+    if (terminalLine->cursorPosition < terminalLine->firstChange) {
+        terminalLine->firstChange = terminalLine->cursorPosition;
+    }
+}
+
+/*
+ * Function: charAt
+ * ----------------------------
+ *   Return the character of the user input at 'position', skipping over the gap.
+ *
+ *   terminalLine: the terminal line to read
+ *   position: position of the character relative to the user input
+ *
+ *   return: the character. '\0' if position is outside the user input.
+ */
+static char charAt(TERMINAL_LINE* terminalLine, int position) {
+    if (position < 0 || position >= terminalLine->length) {
+        return '\0';
+    }
+    if (position < terminalLine->gapStart) {
+        return terminalLine->buffer[position];
+    }
+    return terminalLine->buffer[position + terminalLine->capacity - terminalLine->length];
+}
+
+/*
+ * Function: moveGap
+ * ----------------------------
+ *   Move the gap to 'position'. Only the characters between the old and the
+ *   new position of the gap are moved.
+ *
+ *   terminalLine: the terminal line to change
+ *   position: new position of the gap relative to the user input
+ */
+static void moveGap(TERMINAL_LINE* terminalLine, int position) {
+    int gapSize = terminalLine->capacity - terminalLine->length;
+    char* buffer = terminalLine->buffer;
+    if (position < terminalLine->gapStart) {
+        memmove(buffer + position + gapSize, buffer + position, terminalLine->gapStart - position);
+    } else if (position > terminalLine->gapStart) {
+        memmove(buffer + terminalLine->gapStart, buffer + terminalLine->gapStart + gapSize, position - terminalLine->gapStart);
+    }
+    terminalLine->gapStart = position;
+}
+
+/*
+ * Function: growLine
+ * ----------------------------
+ *   Double the capacity of the terminal line until it can hold 'minimumCapacity' characters.
+ *   The characters after the gap are moved to the end of the new buffer.
+ *
+ *   terminalLine: the terminal line to grow
+ *   minimumCapacity: number of characters the terminal line must be able to hold
+ */
+static void growLine(TERMINAL_LINE* terminalLine, int minimumCapacity) {
+    if (minimumCapacity <= terminalLine->capacity) {
+        return;
+    }
+    int capacity = terminalLine->capacity > 0 ? terminalLine->capacity : LINE_INITIAL_CAPACITY;
+    while (capacity < minimumCapacity) {
+        capacity *= 2;
     }
-    terminalLine->cursorPosition = terminalLine->cursorPosition - 1;
-    refreshTerminal(terminalLine);
+    int charactersAfterGap = terminalLine->length - terminalLine->gapStart;
+    terminalLine->buffer = (char*) realloc(terminalLine->buffer, capacity);
+    memmove(terminalLine->buffer + capacity - charactersAfterGap,
+            terminalLine->buffer + terminalLine->capacity - charactersAfterGap, charactersAfterGap);
+    terminalLine->capacity = capacity;
 }
 
 //update user input in terminal ///////////////////////////////////////////////////////////////////
@@ -84,274 +443,487 @@ void deleteChar(TERMINAL_LINE* terminalLine){
 * Function: moveCursorToCursorPosition
 * ----------------------------
 *   Some terminal operations alter the terminal line.
-*   This method refreshes the entire terminal line and moves the
-*   cursor to its expected position.
+*   This method redraws the prompt and the entire terminal line, erases
+*   whatever was left after it and moves the cursor to its expected position.
+*   Everything is sent to the terminal with a single write().
 *
 *   terminalLine: stores the input stream to read from,
-*                 the character array to store user input into, 
+*                 the user input,
 *                 the cursor position relative to the user input.
 */
 void moveCursorToCursorPosition(TERMINAL_LINE* terminalLine) {
-    clearTerminalLine(strlen(terminalLine->string));
-    if (terminalLine->inputStream == stdin && isatty(STDIN_FILENO)) {
-        printf(SHELL_PROMPT);
+    if (batchMode) {
+        return;
     }
-    printStringFrom(terminalLine->string, 0);
-    moveCursor(strlen(terminalLine->string) - terminalLine->cursorPosition, 'D');
+    int length = terminalLine->length;
+    //output written from now on is drawn over the line: it must be redrawn again
+    atomic_store_explicit(&renderedLineStale, 0, memory_order_relaxed);
+
+    renderBuffer.length = 0;
+    render_append("\r", 1);
+    if (terminalLine->inputStream == stdin) {
+        render_append(SHELL_PROMPT, strlen(SHELL_PROMPT));
+    }
+    render_appendLine(terminalLine, 0, length);
+    render_append("\033[K", 3); //erase to end of line
+    render_appendCursorMove(length - terminalLine->cursorPosition, 'D');
+    render_flush();
+    render_saveLine(terminalLine);
 }
 
 /*
- * Function: refreshTerminal
+* Function: refreshTerminalLine
+* ----------------------------
+*   Update the terminal line after the user input was edited.
+*   Only the characters from the first one edited since the last redraw are written,
+*   followed by an erase to end of line if the input got shorter. The cursor is moved
+*   relative to its current position. Everything is sent to the terminal with a single write().
+*   If something else was printed since the last redraw (see terminal_outputWritten()),
+*   the prompt and the entire line are redrawn with moveCursorToCursorPosition() instead.
+*
+*   terminalLine: stores the input stream to read from,
+*                 the user input,
+*                 the cursor position relative to the user input.
+*/
+void refreshTerminalLine(TERMINAL_LINE* terminalLine) {
+    if (batchMode) {
+        return;
+    }
+    if (atomic_load_explicit(&renderedLineStale, memory_order_relaxed)) {
+        moveCursorToCursorPosition(terminalLine);
+        return;
+    }
+    int length = terminalLine->length;
+    int firstChange = terminalLine->firstChange;
+
+    renderBuffer.length = 0;
+    if (firstChange >= length && length == renderedLine.length) {
+        //only the cursor moved
+        render_appendCursorMoveTo(renderedLine.cursorPosition, terminalLine->cursorPosition);
+    } else {
+        render_appendCursorMoveTo(renderedLine.cursorPosition, firstChange);
+        render_appendLine(terminalLine, firstChange, length);
+        if (length < renderedLine.length) {
+            render_append("\033[K", 3); //erase to end of line
+        }
+        render_appendCursorMoveTo(length, terminalLine->cursorPosition);
+    }
+    if (renderBuffer.length > 0) {
+        render_flush();
+    }
+    render_saveLine(terminalLine);
+}
+
+/*
+ * Function: render_saveLine
  * ----------------------------
- *   Some terminal operations alter the terminal line.
- *   This method overwrites the altered area and returns the
- *   cursor to its initial position.
+ *   Remember what the terminal shows after a redraw.
  *
- *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
- *                 the cursor position relative to the user input.
+ *   terminalLine: the terminal line that was drawn
  */
-static void refreshTerminal(TERMINAL_LINE* terminalLine) {
-    printStringFrom(terminalLine->string, terminalLine->cursorPosition);
-    moveCursor(strlen(terminalLine->string) - terminalLine->cursorPosition, 'D');
+static void render_saveLine(TERMINAL_LINE* terminalLine) {
+    renderedLine.length = terminalLine->length;
+    renderedLine.cursorPosition = terminalLine->cursorPosition;
+    terminalLine->firstChange = terminalLine->length;
 }
 
 /*
- * Function: clearTerminalLine
+ * Function: render_appendLine
  * ----------------------------
- *   Erase all user data on the terminal line
+ *   Add the characters of the user input located between 'from' and 'to'
+ *   to the render buffer. The characters on each side of the gap are added separately.
  *
- *   strLength: size of user input to erase
+ *   terminalLine: the terminal line to draw
+ *   from: position of the first character to add
+ *   to: position after the last character to add
  */
-static void clearTerminalLine(int strLength){
-    putchar('\r'); //go to begining of line
-    strLength += strlen(SHELL_PROMPT); //account for shell prompt
-    while (strLength-- > 0){
-        putchar(' ');
+static void render_appendLine(TERMINAL_LINE* terminalLine, int from, int to) {
+    int gapStart = terminalLine->gapStart;
+    int gapSize = terminalLine->capacity - terminalLine->length;
+    if (from < gapStart) {
+        int end = to < gapStart ? to : gapStart;
+        render_append(terminalLine->buffer + from, end - from);
+        from = end;
+    }
+    if (from < to) {
+        render_append(terminalLine->buffer + from + gapSize, to - from);
     }
-    putchar('\r');
 }
 
 /*
- * Function: printStringFrom
+ * Function: render_append
  * ----------------------------
- *   Print out a substring of 'string', starting at index
- *   'start' and ending at strlen(string)
+ *   Add characters to the render buffer, growing it if needed.
  *
- *   string: string to print
- *   start: index of string where we want to start printing
+ *   data: characters to add
+ *   length: number of characters to add
  */
-static void printStringFrom(const char* const string, int start){
-    for (; string[start]!= '\0'; start++){
-        putchar(string[start]);
+static void render_append(const char* data, size_t length) {
+    if (renderBuffer.length + length > renderBuffer.capacity) {
+        renderBuffer.capacity = (renderBuffer.length + length) * 2;
+        renderBuffer.data = (char*) realloc(renderBuffer.data, renderBuffer.capacity);
+    }
+    memcpy(renderBuffer.data + renderBuffer.length, data, length);
+    renderBuffer.length += length;
+}
+
+/*
+ * Function: render_appendCursorMove
+ * ----------------------------
+ *   Add the escape sequence moving the cursor by 'moveBy' characters
+ *   in the direction described by 'direction' to the render buffer.
+ *   valid directions: A = up, B = down, C = right, D = left
+ * 
+ *   moveBy: number of characters to move by
+ *   direction: direction we want to move in
+ */
+static void render_appendCursorMove(int moveBy, char direction) {
+    if (moveBy <= 0){
+        return;
     }
-    //clean up end of terminal line
-    printf("    \b\b\b\b");
+    char sequence[16];
+    int length = snprintf(sequence, sizeof(sequence), "\033[%d%c", moveBy, direction);
+    render_append(sequence, length);
 }
 
 /*
- * Function: detectEsc_and_ArrowKeys
+ * Function: render_appendCursorMoveTo
  * ----------------------------
- *   ESC and arrow keys share a common initial character. 
- *   This method loops through all instances of ESC on the
- *   input stream and then checks to see if a user pressed
- *   an arrow key.
- *  
- *   Calls the appropriate event_arrowKey() method depending
- *   on whether Ctrl and/or Shift was pressed when arrow keys
- *   were pressed.
+ *   Add the escape sequence moving the cursor from one position of the user input to another.
+ * 
+ *   from: current cursor position relative to user input
+ *   to: position to move the cursor to
+ */
+static void render_appendCursorMoveTo(int from, int to) {
+    if (to < from) {
+        render_appendCursorMove(from - to, 'D');
+    } else {
+        render_appendCursorMove(to - from, 'C');
+    }
+}
+
+/*
+ * Function: render_flush
+ * ----------------------------
+ *   Send the render buffer to STDOUT with a single write().
+ *   Text printed with stdio before the redraw is flushed first so it appears before the terminal line.
+ */
+static void render_flush() {
+    fflush(stdout);
+    size_t written = 0;
+    while (written < renderBuffer.length) {
+        ssize_t result = write(STDOUT_FILENO, renderBuffer.data + written, renderBuffer.length - written);
+        if (result <= 0) {
+            break;
+        }
+        written += result;
+    }
+    renderBuffer.length = 0;
+}
+
+/*
+ * Function: getKey
+ * ----------------------------
+ *   Read the next key pressed by the user.
+ *   Escape sequences are decoded with the escapeSequences table. Navigation keys
+ *   (arrow keys, with or without Ctrl/Shift) are handled here: the cursor is moved
+ *   or the command history is navigated, and 0 is returned.
+ *   Unknown escape sequences are discarded and 0 is returned.
+ *   Ctrl-R searches the command history. The key that ends the search is then handled as usual.
  *
  *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
+ *                 the user input,
  *                 the cursor position relative to the user input.
- *   c: character to store input stream data into
+ *
+ *   return: the character read, 0 if the key was handled, EOF at the end of the input stream
  */
-char detectEsc_and_ArrowKeys(TERMINAL_LINE* terminalLine, char* c){
-
-    //loop until current character is not ESC
-    while (*c == 27) {
-        *c = getc(terminalLine->inputStream);
+int getKey(TERMINAL_LINE* terminalLine) {
+    int c = readByte(terminalLine, -1);
+    if (c == CTRL_R && terminalLine->inputStream == stdin && !batchMode && isatty(STDIN_FILENO)) {
+        c = searchHistory(terminalLine);
+    }
+    if (c != ESC) {
+        return c == INPUT_TIMEOUT ? 0 : c;
     }
 
-    //if next character == 91, we assume an arrow key was pressed (could be a normal keypress)
-    if (*c != 91)
-    {
-        return *c;
-    } 
+    //follow the escape sequence until it matches a single entry of the table
+    char sequence[ESCAPE_SEQUENCE_SIZE];
+    int length = 0;
+    while (length < ESCAPE_SEQUENCE_SIZE - 1) {
+        c = readByte(terminalLine, ESCAPE_TIMEOUT_MS);
+        if (c == EOF || c == INPUT_TIMEOUT) {
+            return 0;   //ESC key on its own is ignored
+        }
+        sequence[length++] = c;
+        sequence[length] = '\0';
 
-    *c = getc(terminalLine->inputStream);
+        int isPrefix = 0;
+        for (int i = 0; i < sizeof(escapeSequences) / sizeof(escapeSequences[0]); i++) {
+            if (!strcmp(escapeSequences[i].sequence, sequence)) {
+                handleNavigationKey(terminalLine, escapeSequences[i].key);
+                return 0;
+            }
+            if (!strncmp(escapeSequences[i].sequence, sequence, length)) {
+                isPrefix = 1;
+            }
+        }
+        if (!isPrefix) {
+            break;
+        }
+    }
 
-    if (*c == 49)   //might be crtl||shift + arrow key
-    {
-        *c = getc(terminalLine->inputStream);
-        if (*c == 59)
-        {
-            *c = getc(terminalLine->inputStream);
-            switch (*c)
-            {
-                case 50:
-                    event_arrowKey_shift(terminalLine, c);
-                break;
-                case 53:
-                    event_arrowKey_ctrl(terminalLine, c);
-                break;
-                case 54:
-                    event_arrowKey_ctrl_shift(terminalLine, c);
+    //ESC followed by a normal key: keep the key
+    if (length == 1 && sequence[0] != '[' && sequence[0] != 'O') {
+        return c;
+    }
+
+    //unknown control sequence (ESC [ parameters final character): discard it up to its final character
+    if (sequence[0] == '[') {
+        while (!(c >= '@' && c <= '~')) {
+            c = readByte(terminalLine, ESCAPE_TIMEOUT_MS);
+            if (c == EOF || c == INPUT_TIMEOUT) {
                 break;
             }
-            *c = getc(terminalLine->inputStream);
         }
-        return *c;
     }
+    return 0;
+}
 
-    //if next character == 65 | 66 | 67 | 68, we pressed an arrow key
-    if (*c >= 65 && *c <= 68)
-    {
-        event_arrowKey(terminalLine, c);
-        //get next character
-        *c = getc(terminalLine->inputStream);
-    }
-    return *c;
+/*
+ * Function: hasPendingInput
+ * ----------------------------
+ *   Return whether keys are waiting to be read, for example when the user pasted text.
+ *   The terminal line does not need to be redrawn until they are processed.
+ *
+ *   terminalLine: stores the input stream to read from,
+ *                 the user input,
+ *                 the cursor position relative to the user input.
+ *
+ *   return: 1 if getKey() will not have to wait for input. 0 otherwise.
+ */
+int hasPendingInput(TERMINAL_LINE* terminalLine) {
+    return terminalLine->inputStream == stdin && inputBuffer.length > 0;
 }
 
 /*
- * Function: event_arrowKey
+ * Function: handleNavigationKey
  * ----------------------------
- *   If user presses arrow keys, this function is called
+ *   Move the cursor or navigate the command history.
  * 
  *   If user presses left:  move cursor left by one character
  *   If user presses right: move cursor right by one character
  *   If user presses up:    get the previous command stored in history
  *   If user presses down:  get the next command stored in history
+ *   If user presses Ctrl and/or Shift-left/right: move cursor left/right by one word
  * 
  *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
+ *                 the user input,
  *                 the cursor position relative to the user input.
- *   c: character to store input stream data into
+ *   key: the navigation key that was pressed
  */
-static void event_arrowKey(TERMINAL_LINE* terminalLine, char* c){
-    //run cursor operation
-    switch (*c) 
+static void handleNavigationKey(TERMINAL_LINE* terminalLine, enum NAVIGATION_KEYS key) {
+    switch (key)
     {
-        case 65:    //up
-            //clear terminal line and print out the retrieved string
-            clearTerminalLine(strlen(terminalLine->string));
-            strcpy(terminalLine->string, history_getPrevious(terminalLine->string));
-            terminalLine->cursorPosition = strlen(terminalLine->string);
-            printf("%s%s", SHELL_PROMPT, terminalLine->string);
+        case KEY_UP:
+            //replace user input with the retrieved string
+            terminalLine_setString(terminalLine, history_getPrevious(terminalLine_getString(terminalLine)));
+        break;
+        case KEY_DOWN:
+            //replace user input with the retrieved string
+            terminalLine_setString(terminalLine, history_getNext(terminalLine_getString(terminalLine)));
+        break;
+        case KEY_RIGHT:
+            moveCursorRight(1, terminalLine);
         break;
-        case 66:    //down
-            //clear terminal line and print out the retrieved string
-            clearTerminalLine(strlen(terminalLine->string));
-            strcpy(terminalLine->string, history_getNext(terminalLine->string));
-            terminalLine->cursorPosition = strlen(terminalLine->string);
-            printf("%s%s", SHELL_PROMPT, terminalLine->string);
+        case KEY_LEFT:
+            moveCursorLeft(1, terminalLine);
         break;
-        case 67:    //right
-            moveCursorRight(1, terminalLine->string, &terminalLine->cursorPosition);
+        case KEY_WORD_RIGHT:
+            jumpToNextWord(terminalLine);
         break;
-        case 68:    //left
-            moveCursorLeft(1, terminalLine->string, &terminalLine->cursorPosition);
+        case KEY_WORD_LEFT:
+            jumpToPreviousWord(terminalLine);
+        break;
+        case KEY_IGNORED:
         break;
     }
 }
 
 /*
- * Function: event_arrowKey_ctrl
+ * Function: searchHistory
  * ----------------------------
- *   If user presses Ctrl-arrow keys, this function is called
+ *   Reverse incremental search through the command history, started by Ctrl-R.
+ *   Every character typed is added to the query and the user input is replaced
+ *   with the most recent command containing it.
  * 
- *   If user presses Ctrl-left:  move cursor left by one word
- *   If user presses Ctrl-right: move cursor right by one word
+ *   Ctrl-R:        find the next older command containing the query
+ *   backspace:     remove the last character of the query
+ *   Ctrl-G:        cancel the search and restore the user input
+ *   any other key: keep the command found and end the search
  *
  *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
+ *                 the user input,
  *                 the cursor position relative to the user input.
- *   c: character to store input stream data into
+ *
+ *   return: the key that ended the search, 0 if it was cancelled
  */
-static void event_arrowKey_ctrl(TERMINAL_LINE* terminalLine, char* c){
-    *c = getc(terminalLine->inputStream);
-    switch (*c)
-    {
-        case 65:    //up
-        
-        break;
-        case 66:    //down
-        
-        break;
-        case 67:    //right
-            jumpToNextWord(terminalLine->string, &terminalLine->cursorPosition);
-        break;
-        case 68:    //left
-            jumpToPreviousWord(terminalLine->string, &terminalLine->cursorPosition);
-        break;
+static int searchHistory(TERMINAL_LINE* terminalLine) {
+    char* userInput = strdup(terminalLine_getString(terminalLine));
+    TERMINAL_LINE query;
+    terminalLine_init(&query, terminalLine->inputStream);
+    int position = -1;  //position of the command found in the history. -1 until one is found
+    int failed = 0;
+    int c;
+
+    while (1) {
+        //pasted text is drawn once it has all been processed
+        if (!hasPendingInput(terminalLine)) {
+            searchHistory_draw(terminalLine, &query, failed);
+        }
+        c = readByte(terminalLine, -1);
+        if (c == CTRL_R) {
+            if (position >= 0) {
+                failed = searchHistory_findMatch(terminalLine, &query, &position, position);
+            }
+        } else if (c == 8 || c == 0x7f) {
+            deleteChar(&query);
+            position = -1;
+            failed = searchHistory_findMatch(terminalLine, &query, &position, -1);
+        } else if (c != EOF && isprint(c)) {
+            insertChar(&query, c);
+            //the command found may still contain the longer query
+            failed = searchHistory_findMatch(terminalLine, &query, &position, position < 0 ? -1 : position + 1);
+        } else if (c == CTRL_G) {
+            terminalLine_setString(terminalLine, userInput);
+            c = 0;
+            break;
+        } else {
+            break;
+        }
+    }
+
+    terminalLine_destroy(&query);
+    free(userInput);
+    if (c != EOF) {
+        moveCursorToCursorPosition(terminalLine);
     }
+    return c;
 }
 
 /*
- * Function: event_arrowKey_shift
+ * Function: searchHistory_findMatch
  * ----------------------------
- *   copy of event_arrowKey_ctrl
- *   If user presses Shift-arrow keys, this function is called
- * 
- *   If user presses Shift-left:     move cursor left by one word
- *   If user presses Shift-right:    move cursor right by one word
+ *   Replace the user input with the most recent command containing the query,
+ *   among the commands located before 'searchBefore' in the history.
+ *   The user input is left unchanged if no command is found.
  *
- *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
- *                 the cursor position relative to the user input.
- *   c: character to store input stream data into
+ *   terminalLine: the terminal line whose user input is replaced
+ *   query: the text to look for
+ *   position: set to the position of the command found
+ *   searchBefore: position of the history to search before. -1 to search the whole history
+ *
+ *   return: 1 if no command contains the query, 0 otherwise
  */
-static void event_arrowKey_shift(TERMINAL_LINE* terminalLine, char* c){
-    *c = getc(terminalLine->inputStream);
-    switch (*c)
-    {
-        case 65:    //up
-        
-        break;
-        case 66:    //down
-        
-        break;
-        case 67:    //right
-            jumpToNextWord(terminalLine->string, &terminalLine->cursorPosition);
-        break;
-        case 68:    //left
-            jumpToPreviousWord(terminalLine->string, &terminalLine->cursorPosition);
-        break;
+static int searchHistory_findMatch(TERMINAL_LINE* terminalLine, TERMINAL_LINE* query, int* position, int searchBefore) {
+    if (query->length == 0) {
+        return 0;
+    }
+    int found = searchBefore;
+    char* command = history_search(terminalLine_getString(query), &found);
+    if (command == NULL) {
+        return 1;
     }
+    terminalLine_setString(terminalLine, command);
+    *position = found;
+    return 0;
 }
 
 /*
- * Function: event_arrowKey_ctrl_shift
+ * Function: searchHistory_draw
  * ----------------------------
- *   copy of event_arrowKey_ctrl
- *   If user presses Ctrl-Shift-arrow keys, this function is called
- * 
- *   If user presses Ctrl-Shift-left:    move cursor left by one word
- *   If user presses Ctrl-Shift-right:   move cursor right by one word
+ *   Replace the terminal line with the search prompt, the query and the command found.
+ *   Everything is sent to the terminal with a single write().
  *
- *   terminalLine: stores the input stream to read from,
- *                 the character array to store user input into, 
- *                 the cursor position relative to the user input.
- *   c: character to store input stream data into
+ *   terminalLine: the terminal line holding the command found
+ *   query: the text being searched
+ *   failed: whether no command contains the query
  */
-static void event_arrowKey_ctrl_shift(TERMINAL_LINE* terminalLine, char* c){
-    *c = getc(terminalLine->inputStream);
-    switch (*c)
-    {
-        case 65:    //up
- 
-        break;
-        case 66:    //down
+static void searchHistory_draw(TERMINAL_LINE* terminalLine, TERMINAL_LINE* query, int failed) {
+    const char* prompt = failed ? "\r(failed reverse-i-search)`" : "\r(reverse-i-search)`";
+    renderBuffer.length = 0;
+    render_append(prompt, strlen(prompt));
+    render_appendLine(query, 0, query->length);
+    render_append("': ", 3);
+    render_appendLine(terminalLine, 0, terminalLine->length);
+    render_append("\033[K", 3); //erase to end of line
+    render_flush();
+}
 
-        break;
-        case 67:    //right
-            jumpToNextWord(terminalLine->string, &terminalLine->cursorPosition);
-        break;
-        case 68:    //left
-            jumpToPreviousWord(terminalLine->string, &terminalLine->cursorPosition);
-        break;
+/*
+ * Function: readByte
+ * ----------------------------
+ *   Read the next byte of the input stream.
+ *   The shell input (STDIN) is read through the input ring buffer. Other streams
+ *   (scripts) are read with getc.
+ *
+ *   terminalLine: stores the input stream to read from
+ *   timeout: maximum number of milliseconds to wait for input. -1 to wait forever
+ *
+ *   return: the byte read, EOF at the end of the input stream, INPUT_TIMEOUT if no input arrived in time
+ */
+static int readByte(TERMINAL_LINE* terminalLine, int timeout) {
+    if (terminalLine->inputStream != stdin) {
+        return getc(terminalLine->inputStream);
+    }
+    if (inputBuffer.length == 0) {
+        int result = input_fill(timeout);
+        if (result == 0) {
+            return INPUT_TIMEOUT;
+        }
+        if (result < 0) {
+            return EOF;
+        }
+    }
+    unsigned char c = inputBuffer.data[inputBuffer.start];
+    inputBuffer.start = (inputBuffer.start + 1) % INPUT_BUFFER_SIZE;
+    inputBuffer.length--;
+    return c;
+}
+
+/*
+ * Function: input_fill
+ * ----------------------------
+ *   Wait for STDIN to have input with poll(), then read() as much of it
+ *   as fits at the end of the input ring buffer.
+ *
+ *   timeout: maximum number of milliseconds to wait for input. -1 to wait forever
+ *
+ *   return: the number of bytes read. 0 if no input arrived in time. -1 at the end of the input.
+ */
+static int input_fill(int timeout) {
+    struct pollfd pollInput = {.fd = STDIN_FILENO, .events = POLLIN};
+    int ready;
+    while ((ready = poll(&pollInput, 1, timeout)) < 0 && errno == EINTR)
+        ;
+    if (ready == 0) {
+        return 0;
+    }
+
+    //the free space may wrap around the end of the buffer: only fill the contiguous part
+    size_t end = (inputBuffer.start + inputBuffer.length) % INPUT_BUFFER_SIZE;
+    size_t space = INPUT_BUFFER_SIZE - inputBuffer.length;
+    if (space > INPUT_BUFFER_SIZE - end) {
+        space = INPUT_BUFFER_SIZE - end;
     }
+
+    ssize_t bytesRead;
+    while ((bytesRead = read(STDIN_FILENO, inputBuffer.data + end, space)) < 0 && errno == EINTR)
+        ;
+    if (bytesRead <= 0) {
+        return -1;
+    }
+    inputBuffer.length += bytesRead;
+    return bytesRead;
 }
 
 /*
@@ -361,19 +933,16 @@ static void event_arrowKey_ctrl_shift(TERMINAL_LINE* terminalLine, char* c){
  *   defined as text that does not include whitespace.
  *   If reached the end of the line, do not go further.
  * 
- *   string: terminal line current input
- *   currentPos: current cursor position relative to user input
+ *   terminalLine: the terminal line whose cursor is moved
  */
-static void jumpToPreviousWord(const char* const string, int* currentPos) {
-    clearTerminalLine(strlen(string));
-    printf("%s%s", SHELL_PROMPT, string);
-    moveCursor(strlen(string) - *currentPos, 'D');
-
-    int position = *currentPos - 1;
-    while (position > 0 && (isspace(string[position]) || isspace(string[position]) == isspace(string[position-1]))) {
+static void jumpToPreviousWord(TERMINAL_LINE* terminalLine) {
+    int currentPos = terminalLine->cursorPosition;
+    int position = currentPos - 1;
+    while (position > 0 && (isspace(charAt(terminalLine, position))
+           || isspace(charAt(terminalLine, position)) == isspace(charAt(terminalLine, position-1)))) {
         position--;
     }
-    moveCursorLeft(*currentPos - position, string, currentPos);
+    moveCursorLeft(currentPos - position, terminalLine);
 }
 
 /*
@@ -383,19 +952,16 @@ static void jumpToPreviousWord(const char* const string, int* currentPos) {
  *   defined as text that does not include whitespace.
  *   If reached the end of the line, do not go further.
  * 
- *   string: terminal line current input
- *   currentPos: current cursor position relative to user input
+ *   terminalLine: the terminal line whose cursor is moved
  */
-static void jumpToNextWord(const char* const string, int* currentPos) {
-    clearTerminalLine(strlen(string));
-    printf("%s%s", SHELL_PROMPT, string);
-    moveCursor(strlen(string) - *currentPos, 'D');
-
-    int position = *currentPos + 1;
-    while (position < strlen(string) && (!isspace(string[position]) || isspace(string[position]) == isspace(string[position+1]))) {
+static void jumpToNextWord(TERMINAL_LINE* terminalLine) {
+    int currentPos = terminalLine->cursorPosition;
+    int position = currentPos + 1;
+    while (position < terminalLine->length && (!isspace(charAt(terminalLine, position))
+           || isspace(charAt(terminalLine, position)) == isspace(charAt(terminalLine, position+1)))) {
         position++;
     }
-    moveCursorRight(position - *currentPos, string, currentPos);
+    moveCursorRight(position - currentPos, terminalLine);
 }
 
 //terminal user navigation/////////////////////////////////////////////////////////////////////////
@@ -406,20 +972,11 @@ static void jumpToNextWord(const char* const string, int* currentPos) {
  *   If reached the end of the line, do not go further.
  *   
  *   moveBy: how many characters to move by
- *   string: terminal line current input
- *   currentPos: current cursor position relative to user input
+ *   terminalLine: the terminal line whose cursor is moved
  */
-static void moveCursorLeft(int moveBy, const char* const string, int* currentPos){
-    if (*currentPos - moveBy >= 0){
-        *currentPos = *currentPos - moveBy;
-        moveCursor(moveBy, 'D');
-        return;
-    } 
-    if (*currentPos == 0){
-        clearTerminalLine(strlen(string));
-        printf("%s%s", SHELL_PROMPT, string);
-        moveCursor(strlen(string), 'D');
-        return;
+static void moveCursorLeft(int moveBy, TERMINAL_LINE* terminalLine){
+    if (terminalLine->cursorPosition - moveBy >= 0){
+        terminalLine->cursorPosition = terminalLine->cursorPosition - moveBy;
     }
 }
 
@@ -430,45 +987,10 @@ static void moveCursorLeft(int moveBy, const char* const string, int* currentPos
  *   If reached the end of the line, do not go further.
  *   
  *   moveBy: how many characters to move by
- *   string: terminal line current input
- *   currentPos: current cursor position relative to user input
- */
-static void moveCursorRight(int moveBy, const char* const string, int* currentPos){
-    if (*currentPos + moveBy <= strlen(string)){
-        *currentPos = *currentPos + moveBy;
-         moveCursor(moveBy, 'C');
-         return;
-    }  
-    if (*currentPos == 0){
-        clearTerminalLine(strlen(string));
-        printf("%s%s", SHELL_PROMPT, string);
-        moveCursor(strlen(string), 'D');
-        return;
-    }
-    if (*currentPos == strlen(string)) {
-        clearTerminalLine(strlen(string));
-        printf("%s%s", SHELL_PROMPT, string);
-        return;
-    }
-}
-
-/*
- * Function: moveCursor
- * ----------------------------
- *   move cursor by 'moveBy' characters in the direction
- *   described by 'direction'
- *   valid directions: A = up, B = down, C = right, D = left
- * 
- *   moveBy: number of characters to move by
- *   direction: direction we want to move in
+ *   terminalLine: the terminal line whose cursor is moved
  */
-static void moveCursor(int moveBy, char direction){
-    if (moveBy <= 0){
-        return;
+static void moveCursorRight(int moveBy, TERMINAL_LINE* terminalLine){
+    if (terminalLine->cursorPosition + moveBy <= terminalLine->length){
+        terminalLine->cursorPosition = terminalLine->cursorPosition + moveBy;
     }
-    if (direction != 'A' && direction != 'B' && direction != 'C' && direction != 'D'){
-        return;
-    }
-
-    printf("\033[%d%c", moveBy, direction);
-}
+}
\ No newline at end of file
@@ -5,20 +5,90 @@
     /* supported shell text colors */
     enum COLORS {
         RED, BLUE, YELLOW, DEFAULT, NUM_COLORS 
-    }COLOURS;
+    };
 
     /*
      * This stuct encapsulates the shell terminal line where users send input.
-     * It includes the input stream to read commands from, a character pointer
-     * to store user input into, and the current cursor position relative to user
-     * input.
+     * It includes the input stream to read commands from, the user input,
+     * and the current cursor position relative to user input.
+     *
+     * The user input is stored in a gap buffer: the characters before the gap are at the
+     * start of 'buffer' and the characters after it are at its end. Edits move the gap to
+     * the cursor first, so typing or deleting characters does not move the rest of the line.
+     * Use terminalLine_getString() to read the user input as a string.
     */
     typedef struct TERMINAL_LINE{
         FILE* inputStream;
-        char* string;
-        int cursorPosition;
+        char* buffer;
+        int capacity;       //size of buffer
+        int length;         //number of characters of user input
+        int gapStart;       //position of the gap in the user input
+        int cursorPosition; //change with terminalLine_setCursor()
+        int firstChange;    //first character that changed since the terminal line was last drawn
     }TERMINAL_LINE;
 
+    /*
+    * Function: terminalLine_init
+    * ----------------------------
+    *   Initialize an empty terminal line.
+    *
+    *   terminalLine: the terminal line to initialize
+    *   inputStream: the input stream to read user input from
+    */
+    extern void terminalLine_init(TERMINAL_LINE* terminalLine, FILE* inputStream);
+
+    /*
+    * Function: terminalLine_destroy
+    * ----------------------------
+    *   Free the memory used by the terminal line.
+    *
+    *   terminalLine: the terminal line to destroy
+    */
+    extern void terminalLine_destroy(TERMINAL_LINE* terminalLine);
+
+    /*
+    * Function: terminalLine_getString
+    * ----------------------------
+    *   Return the user input as a string.
+    *   The string belongs to the terminal line and is only valid until the line is edited.
+    *
+    *   terminalLine: the terminal line to read
+    */
+    extern char* terminalLine_getString(TERMINAL_LINE* terminalLine);
+
+    /*
+    * Function: terminalLine_setString
+    * ----------------------------
+    *   Replace the user input with 'string' and move the cursor to its end.
+    *
+    *   terminalLine: the terminal line to change
+    *   string: the new user input
+    */
+    extern void terminalLine_setString(TERMINAL_LINE* terminalLine, const char* string);
+
+    /*
+    * Function: terminalLine_setCursor
+    * ----------------------------
+    *   Move the cursor. The position is limited to the user input.
+    *
+    *   terminalLine: the terminal line to change
+    *   cursorPosition: the new cursor position relative to the user input
+    */
+    extern void terminalLine_setCursor(TERMINAL_LINE* terminalLine, int cursorPosition);
+
+    /*
+    * Function: terminalLine_replace
+    * ----------------------------
+    *   Replace 'length' characters of the user input starting at 'position' with 'string'.
+    *   The line grows as needed. The cursor is not moved.
+    *
+    *   terminalLine: the terminal line to change
+    *   position: position of the first character to replace
+    *   length: number of characters to replace. 0 inserts 'string' at 'position'.
+    *   string: the text to write in their place. Must not point inside the terminal line.
+    */
+    extern void terminalLine_replace(TERMINAL_LINE* terminalLine, int position, int length, const char* string);
+
     /*
     * Function: moveCursorToCursorPosition
     * ----------------------------
@@ -27,20 +97,34 @@
     *   cursor to its expected position.
     *
     *   terminalLine: stores the input stream to read from,
-    *                 the character array to store user input into, 
+    *                 the user input,
     *                 the cursor position relative to the user input.
     */
     extern void moveCursorToCursorPosition(TERMINAL_LINE* terminalLine);
 
+    /*
+    * Function: refreshTerminalLine
+    * ----------------------------
+    *   Update the terminal line after the user input was edited.
+    *   Only the characters that changed since the last redraw are written.
+    *   If something else was printed since the last redraw (see terminal_outputWritten()),
+    *   the prompt and the entire line are redrawn with moveCursorToCursorPosition() instead.
+    *
+    *   terminalLine: stores the input stream to read from,
+    *                 the user input,
+    *                 the cursor position relative to the user input.
+    */
+    extern void refreshTerminalLine(TERMINAL_LINE* terminalLine);
+
     /*
     * Function: insertChar
     * ----------------------------
     *   Insert the character 'c' at cursor position.
-    *   Update the user input and terminal to reflect the change.
+    *   The terminal is updated by the next call to refreshTerminalLine().
     *
     *   c: character to insert
     *   terminalLine: stores the input stream to read from,
-    *                 the character array to store user input into, 
+    *                 the user input,
     *                 the cursor position relative to the user input.
     */
     extern void insertChar(TERMINAL_LINE* terminalLine, char c);
@@ -49,10 +133,10 @@
     * Function: deleteChar
     * ----------------------------
     *   Delete the character located to the left of the cursor.
-    *   Update the user input and terminal to reflect the change.
+    *   The terminal is updated by the next call to refreshTerminalLine().
     *
     *   terminalLine: stores the input stream to read from,
-    *                 the character array to store user input into, 
+    *                 the user input,
     *                 the cursor position relative to the user input.
     */
     extern void deleteChar(TERMINAL_LINE* terminalLine);
@@ -65,21 +149,74 @@
     extern void setColor(int color);
 
     /*
-    * Function: detectEsc_and_ArrowKeys
+    * Function: printColor
+    * ----------------------------
+    *   printf() a message in color, then switch back to the default color.
+    *
+    *   color: color of the message
+    *   format: printf() format of the message, followed by its arguments
+    */
+    extern void printColor(int color, const char* format, ...);
+
+    /*
+    * Function: terminal_outputWritten
+    * ----------------------------
+    *   Signal that something other than the terminal line was written to STDOUT,
+    *   so the next refreshTerminalLine() redraws the prompt and the entire line.
+    *   Can be called by any thread.
+    */
+    extern void terminal_outputWritten();
+
+    /*
+    * Function: terminal_detectColors
+    * ----------------------------
+    *   Only write colors when STDOUT is a terminal and the NO_COLOR
+    *   environment variable is not set.
+    */
+    extern void terminal_detectColors();
+
+    /*
+    * Function: terminal_setBatchMode
+    * ----------------------------
+    *   Enable or disable batch mode. In batch mode, setColor() does nothing
+    *   and the terminal line is never redrawn.
+    *
+    *   enabled: whether batch mode is enabled
+    */
+    extern void terminal_setBatchMode(int enabled);
+
+    /*
+    * Function: terminal_isBatchMode
     * ----------------------------
-    *   ESC and arrow keys share a common initial character. 
-    *   This method loops through all instances of ESC on the
-    *   input stream and then checks to see if a user pressed
-    *   an arrow key.
-    *  
-    *   Calls the appropriate event_arrowKey() method depending
-    *   on whether Ctrl and/or Shift was pressed when arrow keys
-    *   were pressed.
+    *   return: whether batch mode is enabled
+    */
+    extern int terminal_isBatchMode();
+
+    /*
+    * Function: getKey
+    * ----------------------------
+    *   Read the next key pressed by the user.
+    *   Navigation keys (arrow keys, with or without Ctrl/Shift) are handled here:
+    *   the cursor is moved or the command history is navigated, and 0 is returned.
     *
     *   terminalLine: stores the input stream to read from,
-    *                 the character array to store user input into, 
+    *                 the user input,
     *                 the cursor position relative to the user input.
-    *   c: character to store input stream data into
+    *
+    *   return: the character read, 0 if the key was handled, EOF at the end of the input stream
+    */
+    extern int getKey(TERMINAL_LINE* terminalLine);
+
+    /*
+    * Function: hasPendingInput
+    * ----------------------------
+    *   Return whether keys are waiting to be read, for example when the user pasted text.
+    *
+    *   terminalLine: stores the input stream to read from,
+    *                 the user input,
+    *                 the cursor position relative to the user input.
+    *
+    *   return: 1 if getKey() will not have to wait for input. 0 otherwise.
     */
-    extern char detectEsc_and_ArrowKeys(TERMINAL_LINE* terminalLine, char* c);
+    extern int hasPendingInput(TERMINAL_LINE* terminalLine);
 #endif
\ No newline at end of file
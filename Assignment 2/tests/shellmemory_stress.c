@@ -0,0 +1,125 @@
+/*
+ * Stress test of the shell memory. Threads set and read the same variables, by name and by slot,
+ * the way scripts running on several CPUs do. Run it with "make stress", which builds it with
+ * the thread sanitizer: any data race is reported and makes it fail.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../shellmemory.h"
+
+#define THREADS 8
+#define ITERATIONS 20000
+#define SHARED_VARIABLES 32     //variables every thread writes
+#define PRIVATE_VARIABLES 16    //variables only one thread writes
+
+static int sharedSlots[SHARED_VARIABLES];
+static int failures = 0;
+static pthread_mutex_t failuresLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* stress(void* argument);
+static void fail(const char* format, const char* name, const char* value);
+static int isValue(const char* value, const char* expected);
+
+int main() {
+    //slots are resolved once, like scripts do when they are loaded
+    char name[32];
+    for (int i = 0; i < SHARED_VARIABLES; i++) {
+        sprintf(name, "shared%d", i);
+        sharedSlots[i] = internVar(name);
+        if (sharedSlots[i] == -1 || getVarSlot(sharedSlots[i]) != NULL) {
+            fail("%s: reserving a slot should not create the variable%s\n", name, "");
+        }
+    }
+
+    pthread_t threads[THREADS];
+    for (long i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, stress, (void*) i);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    memory_clear();
+
+    if (failures) {
+        printf("shellmemory stress test: %d failures\n", failures);
+        return 1;
+    }
+    printf("shellmemory stress test: %d threads x %d iterations passed\n", THREADS, ITERATIONS);
+    return 0;
+}
+
+/*
+ * Function: stress
+ * ----------------------------
+ *   Body of every thread. Write a shared variable by slot or by name, and read it back both ways.
+ *   The value read must be one some thread wrote. Private variables must read back exactly.
+ *
+ *   argument: index of the thread
+ */
+static void* stress(void* argument) {
+    int thread = (int) (long) argument;
+    char name[32], value[32];
+    for (int i = 0; i < ITERATIONS; i++) {
+        int shared = (i * 7 + thread) % SHARED_VARIABLES;
+        sprintf(name, "shared%d", shared);
+        sprintf(value, "value%d", i);
+        if (internVar(name) != sharedSlots[shared]) {
+            fail("%s: internVar returned another slot%s\n", name, "");
+        }
+        if ((i % 2 ? setVarSlot(sharedSlots[shared], value) : setVar(name, value))) {
+            fail("%s: could not set %s\n", name, value);
+        }
+
+        char* result = (i % 3) ? getVar(name) : getVarSlot(sharedSlots[shared]);
+        if (!isValue(result, NULL)) {
+            fail("%s: read unexpected value %s\n", name, result ? result : "(null)");
+        }
+        free(result);
+
+        sprintf(name, "private%d_%d", thread, i % PRIVATE_VARIABLES);
+        setVar(name, value);
+        result = getVarSlot(internVar(name));
+        if (!isValue(result, value)) {
+            fail("%s: read %s\n", name, result ? result : "(null)");
+        }
+        free(result);
+    }
+    return NULL;
+}
+
+/*
+ * Function: fail
+ * ----------------------------
+ *   Report a failure.
+ */
+static void fail(const char* format, const char* name, const char* value) {
+    pthread_mutex_lock(&failuresLock);
+    if (failures++ < 10) {
+        printf(format, name, value);
+    }
+    pthread_mutex_unlock(&failuresLock);
+}
+
+/*
+ * Function: isValue
+ * ----------------------------
+ *   Check a value read from the shell memory.
+ *
+ *   value: the value read
+ *   expected: the value that must have been read. NULL if any value written by the test is valid
+ *
+ *   return: 1 if the value is valid. 0 otherwise.
+ */
+static int isValue(const char* value, const char* expected) {
+    if (value == NULL) {
+        return 0;
+    }
+    if (expected != NULL) {
+        return !strcmp(value, expected);
+    }
+    int iteration;
+    char end;
+    return sscanf(value, "value%d%c", &iteration, &end) == 1 && iteration >= 0 && iteration < ITERATIONS;
+}
\ No newline at end of file
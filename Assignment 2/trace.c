@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "stats.h"
+#include "trace.h"
+
+#ifdef TRACING
+
+#define TRACE_MAX_DEPTH 64  //sections of a thread that can be open at the same time when the trace is written
+
+/*
+ * Once the ring wraps, a thread can overwrite a slot while another thread writes or reads it.
+ * sequence is 0 while the slot is written, then the index of its event + 1. trace_write() skips
+ * slots whose sequence changes while they are copied, or that hold another event than expected.
+ */
+struct traceEvent {
+    atomic_ulong sequence;
+    const char* name;
+    long long timestamp;
+    int thread;
+    char phase;
+};
+
+/*
+ * Sections a thread has begun and not ended yet, while the trace is written. End events whose
+ * begin event was overwritten or skipped are dropped, since Chrome would close another section with them.
+ */
+struct openSections {
+    const char* names[TRACE_MAX_DEPTH];
+    int depth;
+};
+
+static struct traceEvent events[TRACE_BUFFER_SIZE];
+static atomic_ulong numberOfEvents = 0;    //total number of events recorded, including overwritten ones
+static atomic_int numberOfThreads = 0;
+static __thread int threadId = -1;
+static const char* traceFilename = NULL;
+static long long startedAt;
+
+static int readEvent(unsigned long index, struct traceEvent* copy);
+static void writeEvent(FILE* file, const struct traceEvent* event, const char* name, char phase, int* first);
+
+/*
+ * Function: trace_start
+ * ----------------------------
+ *   Start recording events. Must be called before any thread other than the main thread is created.
+ *
+ *   filename: name of the file trace_write() will write the events to
+ *
+ *   return: 0 if successful. 1 if the kernel was compiled without tracing.
+ */
+int trace_start(const char* filename) {
+    startedAt = stats_now();
+    traceFilename = filename;
+    return 0;
+}
+
+/*
+ * Function: trace_event
+ * ----------------------------
+ *   Record an event of the calling thread. Does nothing if tracing was not started.
+ *
+ *   name: name of the traced section. Must be a string that outlives the trace
+ *   phase: 'B' when the section begins, 'E' when it ends
+ */
+void trace_event(const char* name, char phase) {
+    if (traceFilename == NULL) {
+        return;
+    }
+    if (threadId == -1) {
+        threadId = atomic_fetch_add_explicit(&numberOfThreads, 1, memory_order_relaxed);
+    }
+
+    unsigned long index = atomic_fetch_add_explicit(&numberOfEvents, 1, memory_order_relaxed);
+    struct traceEvent* event = &events[index & (TRACE_BUFFER_SIZE - 1)];
+    atomic_store_explicit(&event->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    event->name = name;
+    event->timestamp = stats_now();
+    event->thread = threadId;
+    event->phase = phase;
+    atomic_store_explicit(&event->sequence, index + 1, memory_order_release);
+}
+
+/*
+ * Function: trace_write
+ * ----------------------------
+ *   Write the recorded events to the file given to trace_start().
+ *   Does nothing if tracing was not started.
+ *   Events are written oldest first. Timestamps are in microseconds since trace_start().
+ *   Events being overwritten are skipped, and so are end events whose begin event is not in the trace.
+ *
+ *   return: 0 if successful. 1 if the file could not be written.
+ */
+int trace_write() {
+    if (traceFilename == NULL) {
+        return 0;
+    }
+
+    FILE* file = fopen(traceFilename, "w");
+    if (file == NULL) {
+        printf("Could not open file %s\n", traceFilename);
+        return 1;
+    }
+
+    int threads = atomic_load(&numberOfThreads);
+    struct openSections* sections = (struct openSections*) calloc(threads > 0 ? threads : 1, sizeof(struct openSections));
+    unsigned long end = atomic_load(&numberOfEvents);
+    unsigned long start = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+    int first = 1;
+    fprintf(file, "{\"traceEvents\": [");
+    for (unsigned long i = start; i < end; i++) {
+        struct traceEvent event;
+        if (readEvent(i, &event) || event.thread < 0 || event.thread >= threads) {
+            continue;
+        }
+
+        struct openSections* open = &sections[event.thread];
+        if (event.phase == 'B') {
+            if (open->depth < TRACE_MAX_DEPTH) {
+                open->names[open->depth++] = event.name;
+                writeEvent(file, &event, event.name, 'B', &first);
+            }
+            continue;
+        }
+
+        //the end of a section also ends the sections begun inside it whose end event was lost
+        int depth = open->depth;
+        while (depth > 0 && open->names[depth - 1] != event.name) {
+            depth--;
+        }
+        if (depth == 0) {
+            continue;
+        }
+        while (open->depth >= depth) {
+            writeEvent(file, &event, open->names[--open->depth], 'E', &first);
+        }
+    }
+    fprintf(file, "\n], \"displayTimeUnit\": \"ns\"}\n");
+    fclose(file);
+    free(sections);
+    return 0;
+}
+
+/*
+ * Function: readEvent
+ * ----------------------------
+ *   Copy an event out of the ring buffer.
+ *
+ *   index: index of the event, counting overwritten events
+ *   copy: where the event is copied
+ *
+ *   return: 0 if successful. 1 if the slot is being written or holds another event.
+ */
+static int readEvent(unsigned long index, struct traceEvent* copy) {
+    struct traceEvent* event = &events[index & (TRACE_BUFFER_SIZE - 1)];
+    if (atomic_load_explicit(&event->sequence, memory_order_acquire) != index + 1) {
+        return 1;
+    }
+    copy->name = event->name;
+    copy->timestamp = event->timestamp;
+    copy->thread = event->thread;
+    copy->phase = event->phase;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&event->sequence, memory_order_relaxed) != index + 1;
+}
+
+/*
+ * Function: writeEvent
+ * ----------------------------
+ *   Write an event to the trace file.
+ *
+ *   file: the trace file
+ *   event: the event, which gives the timestamp and thread
+ *   name: name of the section
+ *   phase: 'B' or 'E'
+ *   first: whether no event was written yet. Cleared by the call
+ */
+static void writeEvent(FILE* file, const struct traceEvent* event, const char* name, char phase, int* first) {
+    fprintf(file, "%s\n  {\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": %d}", *first ? "" : ",",
+            name, phase, (event->timestamp - startedAt) / 1000.0, event->thread);
+    *first = 0;
+}
+
+#else
+
+/*
+ * Tracing was not compiled in. TRACE_BEGIN/TRACE_END do not call these functions.
+ */
+int trace_start(const char* filename) {
+    fprintf(stderr, "Error: the kernel was compiled without tracing (compile with -DTRACING)\n");
+    return 1;
+}
+
+void trace_event(const char* name, char phase) {
+}
+
+int trace_write() {
+    return 0;
+}
+
+#endif
\ No newline at end of file
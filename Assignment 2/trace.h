@@ -0,0 +1,53 @@
+#ifndef TRACE_HEADER
+    #define TRACE_HEADER
+
+    /*
+     * Tracing of the kernel hot path. Begin/end events are saved in a ring buffer
+     * and written as Chrome trace_event JSON (open the file in chrome://tracing or Perfetto).
+     *
+     * Tracing is only compiled in when TRACING is defined (gcc -DTRACING).
+     * Otherwise TRACE_BEGIN/TRACE_END expand to nothing.
+     * A kernel compiled with tracing records events once trace_start() has been called,
+     * either with --trace FILE or with the MYKERNEL_TRACE environment variable.
+    */
+    #define TRACE_BUFFER_SIZE 65536 //number of events kept. Must be a power of 2. The oldest events are overwritten
+
+    #ifdef TRACING
+        #define TRACE_BEGIN(name) trace_event(name, 'B')
+        #define TRACE_END(name) trace_event(name, 'E')
+    #else
+        #define TRACE_BEGIN(name) ((void) 0)
+        #define TRACE_END(name) ((void) 0)
+    #endif
+
+    /*
+    * Function: trace_start
+    * ----------------------------
+    *   Start recording events. Must be called before any thread other than the main thread is created.
+    *
+    *   filename: name of the file trace_write() will write the events to
+    *
+    *   return: 0 if successful. 1 if the kernel was compiled without tracing.
+    */
+    extern int trace_start(const char* filename);
+
+    /*
+    * Function: trace_event
+    * ----------------------------
+    *   Record an event of the calling thread. Does nothing if tracing was not started.
+    *
+    *   name: name of the traced section. Must be a string that outlives the trace
+    *   phase: 'B' when the section begins, 'E' when it ends
+    */
+    extern void trace_event(const char* name, char phase);
+
+    /*
+    * Function: trace_write
+    * ----------------------------
+    *   Write the recorded events to the file given to trace_start().
+    *   Does nothing if tracing was not started.
+    *
+    *   return: 0 if successful. 1 if the file could not be written.
+    */
+    extern int trace_write();
+#endif
\ No newline at end of file